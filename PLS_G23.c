@@ -1,611 +1,808 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
 #include <strings.h>
-#include <unistd.h>
-#include <sys/wait.h>
 #include <stdbool.h>
 #include <ctype.h>
-#include <sys/ipc.h>
-#include <sys/shm.h>
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "pls.h"
 
-// constant values
-#define ORDER_ID 10
-#define PRODUCT_NAME 10
-#define DATE 11
+// helper function to strip the line break and surrounding blanks of a line in place
+static char* trimLine(char* line) {
+    while (isspace((unsigned char)*line)) line++;
+    char* end = line + strlen(line);
+    while (end > line && isspace((unsigned char)end[-1])) *--end = '\0';
+    return line;
+}
 
-// a structure for the orders in the system
-typedef struct Order {
+// a structure for the fields of an addORDER line
+typedef struct OrderLine {
     char order_number[ORDER_ID], due_date[DATE], product_name[PRODUCT_NAME];
     int quantity;
-    struct Order* next;
-} Order;
-
-// a structure for the scheduling period
-typedef struct Period {
-    char start_date[DATE], end_date[DATE];
-} Period;
-
-// a structure for the information about each plant
-typedef struct Plant{
-    char name[50];
-    int capacity;
-    int days;
-    int produce; 
-} Plant;
-
-// a structure for the shared data for the SJF function
-typedef struct {
-    int days[3];   
-    int produce[3];    
-    int orderQuantities[];  
-} SharedData;
-
-
-// global variables
-static Order* head = NULL;
-static Period scheduling_period;
-int numOrders = 0;
-int numberOfDays = 0;
-Plant plantsArray[3] = {{"Plant_X", 300, 0, 0}, {"Plant_Y", 400, 0, 0},{"Plant_Z", 500, 0, 0}} ;
-Order* rejectedOrders[100];
-int rejectedCount = 0;
-
-
-// function for checking if order is added and batch file is added
-void printOrderHistory() {
+} OrderLine;
+
+// helper function to parse the fields of an addORDER line, false when one is missing or too long for its column
+// (the tokens are read whole, so an order number, date or product that does not fit is rejected rather than cut short)
+static bool parseOrderLine(const char* text, OrderLine* order) {
+    char order_number[64], due_date[64], product_name[64];
+    if (sscanf(text, "%63s %63s %d %63s", order_number, due_date, &order->quantity, product_name) != 4) return false;
+    if (strlen(order_number) >= ORDER_ID || strlen(due_date) != DATE - 1 || strlen(product_name) >= PRODUCT_NAME) return false;
+
+    strcpy(order->order_number, order_number);
+    strcpy(order->due_date, due_date);
+    strcpy(order->product_name, product_name);
+    return true;
+}
 
-    Order* current = head;
+// function to run scheduling algorithms
+// input is expected as "runPLS [algorithm] | printREPORT > [filename]" (the '>' is optional)
+void runPLS(pls_context* ctx, char* input) {
+    char* start = strstr(input, "runPLS");
+    if (start) {
+        start += strlen("runPLS");
+        while (isspace(*start)) start++;
+    } else {
+        start = input;
+    }
 
-    if (current == NULL) {
+    char* token = strtok(start, "|");
+    char* algorithm = token != NULL ? token : "";
+    while (isspace(*algorithm)) algorithm++;
+    char* algorithmEnd = algorithm + strlen(algorithm);
+    while (algorithmEnd > algorithm && isspace(algorithmEnd[-1])) *--algorithmEnd = '\0';
+
+    char* rest = strtok(NULL, "");
+    if (rest) {
+        while (isspace(*rest)) rest++;
+
+        const char* command = "printREPORT";
+        int command_len = strlen(command);
+        if (strncmp(rest, command, command_len) == 0) {
+            char* fileName = rest + command_len;
+            while (isspace(*fileName)) fileName++;
+            if (*fileName == '>') fileName++;
+            while (isspace(*fileName)) fileName++;
+            char* fileNameEnd = fileName + strlen(fileName);
+            while (fileNameEnd > fileName && isspace(fileNameEnd[-1])) *--fileNameEnd = '\0';
+
+            if (*fileName == '\0') {
+                fprintf(stderr, "Invalid input format. Expected '[no space] | printREPORT > [filename]'.\n");
+            } else if (strcasecmp(algorithm, "ALL") == 0) {
+                pls_compare(ctx, fileName);
+            } else if (strcasecmp(algorithm, "FCFS") == 0 || strcasecmp(algorithm, "SJF") == 0 || strcasecmp(algorithm, "EDF") == 0 ||
+                       strcasecmp(algorithm, "GROUP") == 0 || strcasecmp(algorithm, "OPT") == 0) {
+                if (pls_run(ctx, algorithm)) {
+                    pls_report_async(ctx, fileName);
+                }
+            } else {
+                fprintf(stderr, "Invalid algorithm: '%s'\ninput is expected in the format: '[no space] | printREPORT > [filename]'\n", algorithm);
+            }
+        } else {
+            fprintf(stderr, "Command not recognized: '%s'\n", rest);
+        }
+    } else {
+        fprintf(stderr, "Invalid input format. Expected '[no space] | printREPORT > [filename]'.\n");
+    }
+}
 
-        printf("No Order in the history.\n");
+// function to run a capacity sweep
+// input is expected as "sweepPLS [algorithm] [NAME=value,value,...]... > [filename]"
+void sweepPLS(pls_context* ctx, char* input) {
+    char* fileName = strchr(input, '>');
+    if (fileName == NULL) {
+        fprintf(stderr, "Invalid input format. Expected 'sweepPLS [algorithm] [NAME=value,value,...]... > [filename]'.\n");
         return;
     }
-    
-    printf("Order History:\n");
-    printf("%-10s | %-10s | %-8s | %-20s\n", "Order ID", "Due Date", "Quantity", "Product Name");
-    printf("-------------------------------------------------\n");
-    
-    while (current != NULL) {
-        
-        printf("%-10s | %-10s | %-8d | %-20s\n",
-               current->order_number,
-               current->due_date,
-               current->quantity,
-               current->product_name);
-        current = current->next;
+    *fileName++ = '\0';
+    fileName = trimLine(fileName);
+
+    char algorithm[8];
+    int consumed = 0;
+    if (*fileName == '\0' || sscanf(input, "sweepPLS %7s %n", algorithm, &consumed) != 1 || consumed == 0) {
+        fprintf(stderr, "Invalid input format. Expected 'sweepPLS [algorithm] [NAME=value,value,...]... > [filename]'.\n");
+        return;
     }
+    pls_sweep(ctx, algorithm, input + consumed, fileName);
 }
 
-// function to add an order to the rejected list if it cannot be executed
-void rejectOrder(Order* order) {
-    rejectedOrders[rejectedCount++] = order;
-    printf("Order %s rejected as it cannot be completed by its due date %s.\n", order->order_number, order->due_date);
+// function to run one command line, false once the command is exitPLS
+static bool executeCommand(pls_context* ctx, char* command) {
+    if (strncmp(command, "addPERIOD", 9) == 0) {
+        char start_date[DATE], end_date[DATE];
+        if (sscanf(command, "addPERIOD %10s %10s", start_date, end_date) == 2) {
+            pls_set_period(ctx, start_date, end_date);
+        }
+    } else if (strncmp(command, "addPLANT", 8) == 0) {
+        char name[PLANT_NAME];
+        int capacity;
+        if (sscanf(command, "addPLANT %49s %d", name, &capacity) == 2) {
+            pls_add_plant(ctx, name, capacity);
+        }
+    } else if (strncmp(command, "addDOWNTIME", 11) == 0) {
+        char name[PLANT_NAME], first_date[DATE], last_date[DATE];
+        int fields = sscanf(command, "addDOWNTIME %49s %10s %10s", name, first_date, last_date);
+        if (fields >= 2) {
+            pls_add_downtime(ctx, name, first_date, fields == 3 ? last_date : first_date);
+        }
+    } else if (strncmp(command, "addHOLIDAY", 10) == 0) {
+        char first_date[DATE], last_date[DATE];
+        int fields = sscanf(command, "addHOLIDAY %10s %10s", first_date, last_date);
+        if (fields >= 1) {
+            pls_add_holiday(ctx, first_date, fields == 2 ? last_date : first_date);
+        }
+    } else if (strcmp(command, "clearCALENDAR") == 0) {
+        pls_clear_calendar(ctx);
+    } else if (strncmp(command, "addORDER", 8) == 0) {
+        char* line = strtok(command + 8, "\n");
+        while (line != NULL) {
+            OrderLine order;
+            if (parseOrderLine(line, &order)) {
+                pls_add_order(ctx, order.order_number, order.due_date, order.quantity, order.product_name);
+            } else {
+                fprintf(stderr, "Invalid order: '%s' (order number up to %d characters, YYYY-MM-DD, quantity, product up to %d)\n",
+                        trimLine(line), ORDER_ID - 1, PRODUCT_NAME - 1);
+            }
+            line = strtok(NULL, "\n");
+        }
+    } else if (strncmp(command, "addBATCH", 8) == 0) {
+        char file_name[256];
+        if (sscanf(command, "addBATCH %255s", file_name) == 1) {
+            pls_load_batch(ctx, file_name);
+        }
+    } else if (strncmp(command, "saveSNAPSHOT", 12) == 0) {
+        char file_name[256];
+        if (sscanf(command, "saveSNAPSHOT %255s", file_name) == 1) {
+            pls_save_snapshot(ctx, file_name);
+        }
+    } else if (strncmp(command, "loadSNAPSHOT", 12) == 0) {
+        char file_name[256];
+        if (sscanf(command, "loadSNAPSHOT %255s", file_name) == 1) {
+            pls_load_snapshot(ctx, file_name);
+        }
+    } else if (strncmp(command, "traceLEVEL", 10) == 0) {
+        int level;
+        if (sscanf(command, "traceLEVEL %d", &level) == 1) {
+            pls_set_trace_level(ctx, level);
+        }
+    } else if (strncmp(command, "reportFORMAT", 12) == 0) {
+        char format[8];
+        if (sscanf(command, "reportFORMAT %7s", format) == 1) {
+            if (strcasecmp(format, "TEXT") == 0) {
+                pls_set_report_format(ctx, PLS_REPORT_TEXT);
+            } else if (strcasecmp(format, "CSV") == 0) {
+                pls_set_report_format(ctx, PLS_REPORT_CSV);
+            } else if (strcasecmp(format, "TSV") == 0) {
+                pls_set_report_format(ctx, PLS_REPORT_TSV);
+            } else {
+                fprintf(stderr, "Invalid report format: '%s' (TEXT, CSV or TSV)\n", format);
+            }
+        }
+    } else if (strncmp(command, "changeoverDAYS", 14) == 0) {
+        int days;
+        if (sscanf(command, "changeoverDAYS %d", &days) == 1) {
+            pls_set_changeover(ctx, days);
+        }
+    } else if (strncmp(command, "optBUDGET", 9) == 0) {
+        int milliseconds;
+        if (sscanf(command, "optBUDGET %d", &milliseconds) == 1) {
+            pls_set_opt_budget(ctx, milliseconds);
+        }
+    } else if (strncmp(command, "statsPLS", 8) == 0) {
+        char option[8], file_name[256];
+        if (sscanf(command, "statsPLS %7s", option) != 1) {
+            pls_print_stats(ctx, stdout);
+        } else if (strcasecmp(option, "ON") == 0) {
+            pls_enable_stats(ctx, true);
+        } else if (strcasecmp(option, "OFF") == 0) {
+            pls_enable_stats(ctx, false);
+        } else if (strcasecmp(option, "RESET") == 0) {
+            pls_reset_stats(ctx);
+        } else if (strcasecmp(option, "FILE") == 0) {
+            if (sscanf(command, "statsPLS %*s %255s", file_name) == 1 && strcasecmp(file_name, "OFF") != 0) {
+                pls_set_stats_file(ctx, file_name);
+            } else {
+                pls_set_stats_file(ctx, NULL);
+            }
+        } else {
+            fprintf(stderr, "Invalid statsPLS option: '%s' (ON, OFF, RESET or FILE [filename])\n", option);
+        }
+    } else if (strncmp(command, "cachePLS", 8) == 0) {
+        char option[8], directory[256];
+        if (sscanf(command, "cachePLS %7s", option) != 1) {
+            fprintf(stderr, "Invalid input format. Expected 'cachePLS ON|OFF|DIR [directory]'.\n");
+        } else if (strcasecmp(option, "ON") == 0) {
+            pls_enable_cache(ctx, true);
+        } else if (strcasecmp(option, "OFF") == 0) {
+            pls_enable_cache(ctx, false);
+        } else if (strcasecmp(option, "DIR") == 0) {
+            if (sscanf(command, "cachePLS %*s %255s", directory) == 1 && strcasecmp(directory, "OFF") != 0) {
+                pls_set_cache_dir(ctx, directory);
+            } else {
+                pls_set_cache_dir(ctx, NULL);
+            }
+        } else {
+            fprintf(stderr, "Invalid cachePLS option: '%s' (ON, OFF or DIR [directory])\n", option);
+        }
+    } else if (strcmp(command, "waitREPORT") == 0) {
+        pls_wait_reports(ctx);
+    } else if (strcmp(command, "statusREPORT") == 0) {
+        printf("Reports being written: %d\n", pls_pending_reports(ctx));
+    } else if (strncmp(command, "sweepPLS", 8) == 0) {
+        sweepPLS(ctx, command);
+    } else if (strncmp(command, "runPLS", 6) == 0) {
+        runPLS(ctx, command);
+    } else if (strcmp(command, "exitPLS") == 0) {
+        return false;
+    } else if (strcmp(command, "print") == 0) {
+        pls_print_orders(ctx);
+    } else {
+        fprintf(stderr, "WRONG COMMAND.\n");
+    }
+    return true;
 }
 
-// function to add scheduling period
-void period(const char* start_date, const char* end_date) {
-
-    strcpy(scheduling_period.start_date, start_date);
-    strcpy(scheduling_period.end_date, end_date);
-    printf("Scheduling period set succesfully (%s to %s)\n", start_date, end_date);
-
+// constant values of script mode: addORDER lines are handed over in blocks of this many,
+// and the reader stays at most this many blocks ahead of the commands being run
+#define SCRIPT_BLOCK_ORDERS 4096
+#define SCRIPT_QUEUE_BLOCKS 64
+
+// a structure for one step of a script: a run of parsed addORDER lines, or one other command line
+typedef struct ScriptBlock {
+    OrderLine* orders;
+    int orderCount;
+    char* command;              // NULL for a run of orders
+    struct ScriptBlock* next;
+} ScriptBlock;
+
+// a structure for the blocks read but not yet run, shared by the reader thread and main
+typedef struct ScriptQueue {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    ScriptBlock* head;
+    ScriptBlock* tail;
+    int count;
+    bool finished;              // the reader has reached the end of the script
+    bool stopped;               // main has run exitPLS and wants no more blocks
+    FILE* input;                // (whichever of main and the reader sees both flags set frees the queue)
+} ScriptQueue;
+
+// helper function to release a block
+static void freeBlock(ScriptBlock* block) {
+    free(block->orders);
+    free(block->command);
+    free(block);
 }
 
-// function to calculate the number of days in the scheduling period 
-void calculateDays(const char* start_date, const char* end_date) {
-    struct tm tm_start, tm_end;
-    time_t time_start, time_end;
-
-    memset(&tm_start, 0, sizeof(struct tm));
-    memset(&tm_end, 0, sizeof(struct tm));
-
-    if (strptime(start_date, "%Y-%m-%d", &tm_start) == NULL) {
-        printf("Error parsing start date.\n");
-        numberOfDays = -1;
-    }
-    if (strptime(end_date, "%Y-%m-%d", &tm_end) == NULL) {
-        printf("Error parsing end date.\n");
-        numberOfDays = -1;
-    }
-    time_start = mktime(&tm_start);
-    time_end = mktime(&tm_end);
-
-    if (time_start == -1 || time_end == -1) {
-        printf("Error converting dates to time.\n");
-        numberOfDays = -1;
+// helper function to release a queue and the blocks left in it
+static void freeQueue(ScriptQueue* queue) {
+    while (queue->head != NULL) {
+        ScriptBlock* block = queue->head;
+        queue->head = block->next;
+        freeBlock(block);
     }
-
-    double seconds_diff = difftime(time_end, time_start);
-    int days_diff = (int)(seconds_diff / (24 * 3600));
-
-    numberOfDays = days_diff;
+    pthread_mutex_destroy(&queue->lock);
+    pthread_cond_destroy(&queue->changed);
+    free(queue);
 }
 
-// function to calculate the difference in days between any two dates
-int calculateNumberOfDays(const char* start_date, const char* end_date) {
-    struct tm tm_start, tm_end;
-    time_t time_start, time_end;
-
-    memset(&tm_start, 0, sizeof(struct tm));
-    memset(&tm_end, 0, sizeof(struct tm));
-
-    if (strptime(start_date, "%Y-%m-%d", &tm_start) == NULL) {
-        printf("Error parsing start date.\n");
-        return -1;
-    }
-    if (strptime(end_date, "%Y-%m-%d", &tm_end) == NULL) {
-        printf("Error parsing end date.\n");
-        return -1;
+// helper function to hand a block to main, waiting while the queue is full (false once main has stopped)
+static bool pushBlock(ScriptQueue* queue, ScriptBlock* block) {
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count >= SCRIPT_QUEUE_BLOCKS && !queue->stopped) {
+        pthread_cond_wait(&queue->changed, &queue->lock);
     }
-
-    time_start = mktime(&tm_start);
-    time_end = mktime(&tm_end);
-
-    if (time_start == -1 || time_end == -1) {
-        printf("Error converting dates to time.\n");
-        return -1;
+    bool stopped = queue->stopped;
+    if (!stopped) {
+        if (queue->tail != NULL) {
+            queue->tail->next = block;
+        } else {
+            queue->head = block;
+        }
+        queue->tail = block;
+        queue->count++;
+        pthread_cond_broadcast(&queue->changed);
     }
+    pthread_mutex_unlock(&queue->lock);
 
-    double seconds_diff = difftime(time_end, time_start);
-    int days_diff = (int)(seconds_diff / (24 * 3600));
-
-    return days_diff;
+    if (stopped) freeBlock(block);
+    return !stopped;
 }
 
-// helper function to check if an order can be completed within its due date (if needs to be rejected of not)
-bool canCompleteOrder(Order* order, int plantCapacity, const char* currentDate) {
-    int daysToDue = calculateNumberOfDays(currentDate, order->due_date);
-    int totalProductionNeeded = (order->quantity + plantCapacity - 1) / plantCapacity; 
-    return totalProductionNeeded <= daysToDue;
+// helper function to take the next block, NULL at the end of the script
+static ScriptBlock* popBlock(ScriptQueue* queue) {
+    pthread_mutex_lock(&queue->lock);
+    while (queue->head == NULL && !queue->finished) {
+        pthread_cond_wait(&queue->changed, &queue->lock);
+    }
+    ScriptBlock* block = queue->head;
+    if (block != NULL) {
+        queue->head = block->next;
+        if (queue->head == NULL) queue->tail = NULL;
+        queue->count--;
+        pthread_cond_broadcast(&queue->changed);
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return block;
 }
 
-// function to add an order or multiple lines of order
-void order(const char* order_number, const char* due_date, int quantity, const char* product_name) {
-    
-    Order* current = head;
-    while (current != NULL) {
-        
-        if (strcmp(current->order_number, order_number) == 0) {
-            printf("Order number: %s already exists. Duplicate not added.\n", order_number);
-            return; 
-            
+// function for the reader thread: reads and parses the script while main runs the commands before it
+static void* readScript(void* argument) {
+    ScriptQueue* queue = (ScriptQueue*)argument;
+    char* buffer = NULL;
+    size_t bufferSize = 0;
+    ScriptBlock* orders = NULL;
+    bool running = true;
+
+    while (running && getline(&buffer, &bufferSize, queue->input) >= 0) {
+        char* line = trimLine(buffer);
+        if (*line == '\0' || *line == '#') continue;
+
+        OrderLine parsed;
+        if (strncmp(line, "addORDER", 8) == 0 && parseOrderLine(line + 8, &parsed)) {
+            if (orders == NULL) {
+                orders = (ScriptBlock*)calloc(1, sizeof(ScriptBlock));
+                if (orders != NULL) orders->orders = (OrderLine*)malloc(SCRIPT_BLOCK_ORDERS * sizeof(OrderLine));
+                if (orders == NULL || orders->orders == NULL) {
+                    fprintf(stderr, "Out of memory.\n");
+                    if (orders != NULL) freeBlock(orders);
+                    orders = NULL;
+                    break;
+                }
+            }
+            orders->orders[orders->orderCount++] = parsed;
+            if (orders->orderCount == SCRIPT_BLOCK_ORDERS) {
+                running = pushBlock(queue, orders);
+                orders = NULL;
+            }
+            continue;
         }
 
-        current = current->next;
+        // any other line ends the current run of orders, so the commands keep their order
+        if (orders != NULL) {
+            running = pushBlock(queue, orders);
+            orders = NULL;
+            if (!running) break;
+        }
+        ScriptBlock* block = (ScriptBlock*)calloc(1, sizeof(ScriptBlock));
+        if (block != NULL) block->command = strdup(line);
+        if (block == NULL || block->command == NULL) {
+            fprintf(stderr, "Out of memory.\n");
+            if (block != NULL) freeBlock(block);
+            break;
+        }
+        running = pushBlock(queue, block);
     }
-
-    Order* new_order = (Order*)malloc(sizeof(Order));
-    strcpy(new_order->order_number, order_number);
-    strcpy(new_order->due_date, due_date);
-    new_order->quantity = quantity;
-    strcpy(new_order->product_name, product_name);
-    new_order->next = NULL;
-
-    if (head == NULL) {
-
-        head = new_order;
-
-    } else {
-
-        current = head;
-
-        while (current->next != NULL) {
-            current = current->next;
+    if (orders != NULL) {
+        if (running) {
+            pushBlock(queue, orders);
+        } else {
+            freeBlock(orders);
         }
-
-        current->next = new_order;
     }
-
-    printf("Order Successful (%s).\n", order_number);
+    free(buffer);
+
+    pthread_mutex_lock(&queue->lock);
+    queue->finished = true;
+    pthread_cond_broadcast(&queue->changed);
+    bool release = queue->stopped;
+    pthread_mutex_unlock(&queue->lock);
+    if (release) freeQueue(queue);
+    return NULL;
 }
 
-// helper function to sort the orders using bubble sort for shortest job first scheduling algorithm
-void bubbleSortOrders(Order **head) {
-    int swapped;
-    Order *ptr1;
-    Order *lptr = NULL;
-    Order *temp;
-
-    if (*head == NULL) return;
-
-    do {
-        swapped = 0;
-        ptr1 = *head;
-
-        while (ptr1->next != lptr) {
-            if (ptr1->quantity > ptr1->next->quantity) {
-                // swap
-                Order *tmp = ptr1->next;
-                ptr1->next = tmp->next;
-                tmp->next = ptr1;
-
-                if (ptr1 == *head) {
-                    *head = tmp;
-                } else {
-                    Order *prev = *head;
-                    while (prev->next != ptr1) prev = prev->next;
-                    prev->next = tmp;
-                }
-
-                ptr1 = tmp;
-                swapped = 1;
-            }
-            ptr1 = ptr1->next;
+// function to read and run commands one line at a time until exitPLS or the end of the input
+// (lines can be of any length; the prompt is only printed when asked for)
+static void runLines(pls_context* ctx, FILE* input, bool prompt) {
+    char* buffer = NULL;
+    size_t bufferSize = 0;
+    while (1) {
+        if (prompt) printf("Please enter:\n> ");
+        if (getline(&buffer, &bufferSize, input) < 0) {
+            if (prompt) printf("\n");
+            break;
         }
-        lptr = ptr1;
-    } while (swapped);
-}
-
-// helper function to count the number of remaining elements
-int countOrders(Order *head) {
-    int count = 0;
-    while (head) {
-        count++;
-        head = head->next;
+        char* command = trimLine(buffer);
+        if (*command == '\0' || (!prompt && *command == '#')) continue;
+        if (!executeCommand(ctx, command)) break;
     }
-    return count;
+    free(buffer);
 }
 
-// function to print the report into a file 
-void printReport(const char* algorithm, const char* fileName) {
-    FILE* report_file = fopen(fileName, "w");
-    if (report_file == NULL) {
-        printf("Error opening report file.\n");
+// function to run a script without prompts, parsing ahead on a reader thread while the commands run
+// (stops at exitPLS or at the end of the script)
+static void runScript(pls_context* ctx, FILE* input) {
+    ScriptQueue* queue = (ScriptQueue*)calloc(1, sizeof(ScriptQueue));
+    if (queue == NULL) {
+        runLines(ctx, input, false);
         return;
     }
-
-    fprintf(report_file, "***PLS Schedule Analysis Report***\n");
-    fprintf(report_file, "Algorithm used: %s\n", algorithm);
-
-    fprintf(report_file, "There are %d Orders ACCEPTED. Details are as follows:\n", (numOrders - rejectedCount));
-    fprintf(report_file, "ORDER NUMBER START END DAYS QUANTITY PLANT\n");
-    fprintf(report_file, "===========================================================================\n");
-
-    Order* current = head;
-    while (current != NULL) {
-        fprintf(report_file, "%s %s %s %d\n", current->order_number, scheduling_period.start_date, scheduling_period.end_date, current->quantity);
-        current = current->next;
-    }
-    fprintf(report_file, "- End -\n");
-    fprintf(report_file, "===========================================================================\n\n");
-
-    fprintf(report_file, "There are %d Orders REJECTED. Details are as follows:\n", rejectedCount);
-    fprintf(report_file, "ORDER NUMBER PRODUCT NAME Due Date QUANTITY\n");
-    fprintf(report_file, "===========================================================================\n");
-
-    for (int i = 0; i < rejectedCount; i++) {
-        fprintf(report_file, "%s %s %s %d\n", rejectedOrders[i]->order_number, rejectedOrders[i]->product_name, rejectedOrders[i]->due_date, rejectedOrders[i]->quantity);
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->changed, NULL);
+    queue->input = input;
+
+    pthread_t reader;
+    if (pthread_create(&reader, NULL, readScript, queue) != 0) {
+        free(queue);
+        runLines(ctx, input, false);
+        return;
     }
-    fprintf(report_file, "- End -\n");
-    fprintf(report_file, "===========================================================================\n\n");
-
-    fprintf(report_file, "***PERFORMANCE\n\n");
+    pthread_detach(reader);
 
-    double totalProduce = 0, totalCapacity = 0;
-    for (int i = 0; i < 3; i++) {
-        int totalProduceForPlant = plantsArray[i].capacity * plantsArray[i].days;
-        totalCapacity += totalProduceForPlant;
-        double plantUtil = totalProduceForPlant == 0 ? 0 : (double)plantsArray[i].produce / totalProduceForPlant;
-        fprintf(report_file, "%s:\n", plantsArray[i].name);
-        fprintf(report_file, "Number of days in use: %d days\n", plantsArray[i].days);
-        fprintf(report_file, "Number of products produced: %d (in total)\n", plantsArray[i].produce);
-        fprintf(report_file, "Utilization of the plant: %.2f %%\n\n", plantUtil * 100);
-        totalProduce += plantsArray[i].produce;
+    ScriptBlock* block;
+    bool running = true;
+    while (running && (block = popBlock(queue)) != NULL) {
+        if (block->command != NULL) {
+            running = executeCommand(ctx, block->command);
+        } else {
+            for (int i = 0; i < block->orderCount; i++) {
+                const OrderLine* order = &block->orders[i];
+                pls_add_order(ctx, order->order_number, order->due_date, order->quantity, order->product_name);
+            }
+        }
+        freeBlock(block);
     }
 
-    double overallUtil = totalCapacity == 0 ? 0 : (totalProduce / totalCapacity);
-    fprintf(report_file, "Overall utilization: %.2f %%\n\n", overallUtil * 100);
+    // after exitPLS the reader may still be blocked on the input, so it is not waited for
+    pthread_mutex_lock(&queue->lock);
+    queue->stopped = true;
+    pthread_cond_broadcast(&queue->changed);
+    bool release = queue->finished;
+    pthread_mutex_unlock(&queue->lock);
+    if (release) freeQueue(queue);
+}
 
-    fclose(report_file);
-    printf("Report generated successfully.\n");
+// a structure for a request of server mode: one order, or one other command a connection waits on
+typedef struct Request {
+    _Atomic(struct Request*) next;
+    OrderLine order;
+    char* command;              // NULL for an order
+    struct Connection* connection;
+} Request;
+
+// a structure for a client of server mode
+typedef struct Connection {
+    int fd;
+    pthread_mutex_t lock;
+    pthread_cond_t done;
+    bool finished;              // the command the connection waits on has been run
+} Connection;
+
+// a structure for the lock-free queue of requests: many connection threads push, the scheduler thread pops
+// (intrusive, with a stub node so that a push is one exchange and one store)
+typedef struct RequestQueue {
+    _Atomic(Request*) head;     // last pushed, swapped by the producers
+    Request* tail;              // next to pop, only touched by the consumer
+    Request stub;
+    atomic_int sleeping;        // the consumer is about to wait on wakeup
+    sem_t wakeup;
+} RequestQueue;
+
+static RequestQueue requests;
+static atomic_int stopServer;     // set by SIGINT or SIGTERM
+
+// helper function to push a request (safe from any number of threads at once)
+static void pushRequest(RequestQueue* queue, Request* request) {
+    atomic_store_explicit(&request->next, NULL, memory_order_relaxed);
+    Request* previous = atomic_exchange_explicit(&queue->head, request, memory_order_acq_rel);
+    atomic_store_explicit(&previous->next, request, memory_order_release);
 }
 
-// helper function to assign orders to plants using SJF
-void assignOrdersToPlantsSJF(Order* head, const char* fileName, const char* algorithm) {
-    if (!head) return;
+// helper function to push a request and wake the consumer if it is waiting
+static void submitRequest(Request* request) {
+    pushRequest(&requests, request);
+    if (atomic_exchange(&requests.sleeping, 0)) sem_post(&requests.wakeup);
+}
 
-    int orderCount = countOrders(head);
-    Order* orderArray[orderCount];
-    int index = 0;
-    for (Order* current = head; current != NULL; current = current->next) {
-        if (canCompleteOrder(current, plantsArray[0].capacity, scheduling_period.start_date)) {
-            orderArray[index++] = current;
-        } else {
-            rejectOrder(current);
-        }
+// helper function to pop the oldest request, NULL when the queue is empty or a push is half done
+static Request* popRequest(RequestQueue* queue) {
+    Request* tail = queue->tail;
+    Request* next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    if (tail == &queue->stub) {
+        if (next == NULL) return NULL;
+        queue->tail = next;
+        tail = next;
+        next = atomic_load_explicit(&tail->next, memory_order_acquire);
     }
-
-    int shmid = shmget(IPC_PRIVATE, sizeof(SharedData) + sizeof(int) * orderCount, IPC_CREAT | 0666);
-    if (shmid < 0) {
-        perror("shmget");
-        exit(EXIT_FAILURE);
+    if (next != NULL) {
+        queue->tail = next;
+        return tail;
     }
-
-    SharedData* sharedData = (SharedData*)shmat(shmid, NULL, 0);
-    if (sharedData == (SharedData*)-1) {
-        perror("shmat");
-        exit(EXIT_FAILURE);
+    if (tail != atomic_load_explicit(&queue->head, memory_order_acquire)) return NULL;
+
+    // tail is the only request left: put the stub back behind it so that it can be taken
+    pushRequest(queue, &queue->stub);
+    next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    if (next != NULL) {
+        queue->tail = next;
+        return tail;
     }
+    return NULL;
+}
 
+// helper function to check whether nothing at all has been pushed since the last pop
+static bool requestsEmpty(RequestQueue* queue) {
+    return atomic_load(&queue->head) == queue->tail && atomic_load(&queue->tail->next) == NULL;
+}
 
-    memset(sharedData->days, 0, sizeof(sharedData->days));
-    memset(sharedData->produce, 0, sizeof(sharedData->produce));
-    for (int i = 0; i < orderCount; i++) {
-        sharedData->orderQuantities[i] = orderArray[i]->quantity;
+// helper function to write a whole reply to a client
+static void reply(int fd, const char* text) {
+    size_t length = strlen(text);
+    while (length > 0) {
+        ssize_t written = write(fd, text, length);
+        if (written <= 0) return;
+        text += written;
+        length -= (size_t)written;
     }
+}
 
-    int numDays = numberOfDays;
-    pid_t pids[numDays];
-    for (int day = 0; day < numDays; day++) {
-        pids[day] = fork();
-        if (pids[day] < 0) {
-            perror("fork");
-            exit(EXIT_FAILURE);
-        } else if (pids[day] == 0) { 
-            printf("Day %d:\n", day + 1);
-
-            int availableOrders[orderCount];
-            memset(availableOrders, 0, sizeof(availableOrders));
-            int availablePlants[3] = {0, 0, 0};
-
-            while (1) {
-                double minTime = 1e9;
-                int minPlant = -1, minOrder = -1;
-
-                for (int i = 0; i < 3; i++) {
-                    if (!availablePlants[i]) {
-                        for (int j = 0; j < orderCount; j++) {
-                            if (!availableOrders[j] && sharedData->orderQuantities[j] > 0) {
-                                double processingTime = (double)sharedData->orderQuantities[j] / plantsArray[i].capacity;
-                                if (processingTime < minTime) {
-                                    minTime = processingTime;
-                                    minPlant = i;
-                                    minOrder = j;
-                                }
-                            }
-                        }
-                    }
-                }
-
-                if (minPlant == -1 || minOrder == -1) break;
-
-                int dailyProduction = plantsArray[minPlant].capacity;
-                int production = (sharedData->orderQuantities[minOrder] < dailyProduction) ? sharedData->orderQuantities[minOrder] : dailyProduction;
+// helper function to check that the report a client's runPLS line asks for is a plain file name, so that it is
+// written in the directory the server was started in (no '/' and no "..")
+static bool plainReportName(const char* line) {
+    const char* report = strchr(line, '|');
+    return report == NULL || (strchr(report, '/') == NULL && strstr(report, "..") == NULL);
+}
 
-                printf("  %s is allocated to Order %s for the day. %d units to be produced. Remaining before production: %d\n", plantsArray[minPlant].name, orderArray[minOrder]->order_number, production, sharedData->orderQuantities[minOrder] - production);
-                sharedData->days[minPlant] += 1;
-                sharedData->produce[minPlant] += production;
-                
-                sharedData->orderQuantities[minOrder] -= production;
+// function for a connection thread: reads the client's lines, queues orders at once and waits on runPLS commands
+// (replies are QUEUED for an order, DONE once a run and its report have finished, ERROR for a malformed order, a report
+// name with '/' or "..", or any other command, BYE for exitPLS; the period, plants and settings are the server's own)
+static void* serveConnection(void* argument) {
+    Connection* connection = (Connection*)argument;
+    FILE* input = fdopen(connection->fd, "r");
+    char* buffer = NULL;
+    size_t bufferSize = 0;
+
+    while (input != NULL && getline(&buffer, &bufferSize, input) >= 0) {
+        char* line = trimLine(buffer);
+        if (*line == '\0') continue;
+        if (strcmp(line, "exitPLS") == 0) {
+            reply(connection->fd, "BYE\n");
+            break;
+        }
+        if (strncmp(line, "addORDER", 8) != 0 && strncmp(line, "runPLS", 6) != 0) {
+            reply(connection->fd, "ERROR unsupported command\n");
+            continue;
+        }
+        if (strncmp(line, "runPLS", 6) == 0 && !plainReportName(line)) {
+            reply(connection->fd, "ERROR report name must be a plain file name\n");
+            continue;
+        }
 
-                availablePlants[minPlant] = 1;
-                availableOrders[minOrder] = 1;
+        Request* request = (Request*)calloc(1, sizeof(Request));
+        if (request == NULL) {
+            reply(connection->fd, "ERROR out of memory\n");
+            continue;
+        }
+        if (strncmp(line, "addORDER", 8) == 0) {
+            OrderLine* order = &request->order;
+            if (!parseOrderLine(line + 8, order)) {
+                free(request);
+                reply(connection->fd, "ERROR malformed order\n");
+                continue;
             }
-            exit(EXIT_SUCCESS); 
+            submitRequest(request);
+            reply(connection->fd, "QUEUED\n");
+            continue;
         }
-    }
-
 
-    for (int i = 0; i < numDays; i++) {
-        waitpid(pids[i], NULL, 0);
+        request->command = strdup(line);
+        if (request->command == NULL) {
+            free(request);
+            reply(connection->fd, "ERROR out of memory\n");
+            continue;
+        }
+        request->connection = connection;
+        pthread_mutex_lock(&connection->lock);
+        connection->finished = false;
+        pthread_mutex_unlock(&connection->lock);
+        submitRequest(request);
+
+        pthread_mutex_lock(&connection->lock);
+        while (!connection->finished) pthread_cond_wait(&connection->done, &connection->lock);
+        pthread_mutex_unlock(&connection->lock);
+        reply(connection->fd, "DONE\n");
     }
 
-    for (int i = 0; i < 3; i++) {
-        plantsArray[i].days += sharedData->days[i];
-        plantsArray[i].produce += sharedData->produce[i];
+    free(buffer);
+    if (input != NULL) {
+        fclose(input);
+    } else {
+        close(connection->fd);
     }
-
-
-    shmdt(sharedData);
-    shmctl(shmid, IPC_RMID, NULL);
-
-    printReport(algorithm, fileName);
+    pthread_mutex_destroy(&connection->lock);
+    pthread_cond_destroy(&connection->done);
+    free(connection);
+    return NULL;
 }
 
-
-// helper function to assign orders to plants using FCFS
-void assignOrdersToPlantsFCFS(Order* head, const char* fileName, const char* algorithm) {
-    if (!head) return;
-
-    int orderCount = countOrders(head);
-    Order* orderArray[orderCount];
-    int index = 0;
-    for (Order* current = head; current != NULL; current = current->next) {
-        if (canCompleteOrder(current, plantsArray[0].capacity, scheduling_period.start_date)) {
-            orderArray[index++] = current;
-        } else {
-            rejectOrder(current);
+// function for the accepting thread: starts a connection thread per client
+static void* acceptConnections(void* argument) {
+    int listener = *(int*)argument;
+    while (!stopServer) {
+        int fd = accept(listener, NULL, NULL);
+        if (fd < 0) continue;
+
+        Connection* connection = (Connection*)calloc(1, sizeof(Connection));
+        pthread_t thread;
+        if (connection == NULL) {
+            close(fd);
+            continue;
         }
-    }
-
-    int numDays = numberOfDays;
-
-    for (int day = 0; day < numDays; day++) {
-        printf("Day %d:\n", day + 1);
-
-        int availablePlants[3] = {0, 0, 0};  
-
-        for (int i = 0; i < 3; i++) {
-            if (!availablePlants[i]) {  
-                for (int j = 0; j < orderCount; j++) {
-                    if (orderArray[j]->quantity > 0) {  
-                        int dailyProduction = plantsArray[i].capacity;
-                        int production = (orderArray[j]->quantity < dailyProduction) ? orderArray[j]->quantity : dailyProduction;
-
-                        printf("  %s is allocated to Order %s for the day. %d units to be produced. Remaining before production: %d\n",
-                            plantsArray[i].name, orderArray[j]->order_number, production, orderArray[j]->quantity);
-
-                        plantsArray[i].days += 1;
-                        plantsArray[i].produce += production;
-
-                        orderArray[j]->quantity -= production;
-                        availablePlants[i] = 1;  
-                        break;  
-                    }
-                }
-            }
+        connection->fd = fd;
+        pthread_mutex_init(&connection->lock, NULL);
+        pthread_cond_init(&connection->done, NULL);
+        if (pthread_create(&thread, NULL, serveConnection, connection) != 0) {
+            close(fd);
+            pthread_mutex_destroy(&connection->lock);
+            pthread_cond_destroy(&connection->done);
+            free(connection);
+            continue;
         }
-        printf("\n");
+        pthread_detach(thread);
     }
-    printReport(algorithm, fileName);
+    return NULL;
 }
 
-// function to run scheduling algorithms
-void runPLS(const char* input) {
-    int fd[2];
-    if (pipe(fd) == -1) {
-        perror("pipe");
-        exit(EXIT_FAILURE);
-    }
+// helper function to stop the server on SIGINT or SIGTERM (sem_post is safe in a signal handler)
+static void handleStop(int signal) {
+    (void)signal;
+    int saved = errno;
+    atomic_store(&stopServer, 1);
+    sem_post(&requests.wakeup);
+    errno = saved;
+}
 
-    pid_t pid = fork();
-    if (pid == -1) {
-        perror("fork");
-        exit(EXIT_FAILURE);
+// helper function to run one request on the scheduler thread
+static void runRequest(pls_context* ctx, Request* request) {
+    if (request->command == NULL) {
+        const OrderLine* order = &request->order;
+        pls_add_order(ctx, order->order_number, order->due_date, order->quantity, order->product_name);
+        free(request);
+        return;
     }
 
-    if (pid == 0) { 
-        close(fd[1]);
+    // only runPLS reaches here: exitPLS only closes the connection that sent it, and other commands are refused
+    // (the report is waited for, so DONE means it is on disk)
+    executeCommand(ctx, request->command);
+    pls_wait_reports(ctx);
+    Connection* connection = request->connection;
+    free(request->command);
+    free(request);
+    pthread_mutex_lock(&connection->lock);
+    connection->finished = true;
+    pthread_cond_signal(&connection->done);
+    pthread_mutex_unlock(&connection->lock);
+}
 
-        char inputBuffer[256];
-        read(fd[0], inputBuffer, sizeof(inputBuffer) - 1);
-        close(fd[0]);
+// function to serve clients on a UNIX domain socket until SIGINT or SIGTERM
+// (the calling thread owns the context and runs every request in the order the queue hands them over)
+static int runServer(pls_context* ctx, const char* path) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "Socket path too long: '%s'\n", path);
+        return 1;
+    }
+    strcpy(address.sun_path, path);
 
-        inputBuffer[sizeof(inputBuffer) - 1] = '\0'; 
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        fprintf(stderr, "Error creating socket.\n");
+        return 1;
+    }
+    unlink(path);
+    if (bind(listener, (struct sockaddr*)&address, sizeof(address)) < 0 || listen(listener, SOMAXCONN) < 0) {
+        fprintf(stderr, "Error listening on %s.\n", path);
+        close(listener);
+        return 1;
+    }
 
-        char* start = strstr(inputBuffer, "runPLS");
-        if (start) {
-            start += strlen("runPLS");
-            while (isspace(*start)) start++; 
-        } else {
-            start = inputBuffer;
+    atomic_init(&requests.stub.next, NULL);
+    atomic_init(&requests.head, &requests.stub);
+    requests.tail = &requests.stub;
+    atomic_init(&requests.sleeping, 0);
+    sem_init(&requests.wakeup, 0, 0);
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, handleStop);
+    signal(SIGTERM, handleStop);
+
+    pthread_t acceptor;
+    if (pthread_create(&acceptor, NULL, acceptConnections, &listener) != 0) {
+        fprintf(stderr, "Error starting the server.\n");
+        close(listener);
+        unlink(path);
+        return 1;
+    }
+    pthread_detach(acceptor);
+    printf("PLS server listening on %s\n", path);
+    fflush(stdout);
+
+    while (!stopServer) {
+        Request* request = popRequest(&requests);
+        if (request != NULL) {
+            runRequest(ctx, request);
+            continue;
         }
-
-        char* token = strtok(start, "|");
-        char* algorithm = token != NULL ? token : "";
-        while (isspace(*algorithm)) algorithm++; 
-
-        char* rest = strtok(NULL, "");
-        if (rest) {
-            while (isspace(*rest)) rest++; 
-
-            const char* command = "printREPORT ";
-            int command_len = strlen(command);
-            if (strncmp(rest, command, command_len) == 0) {
-                char* fileName = rest + command_len;
-                while (isspace(*fileName)) fileName++;  
-
-                if (strcasecmp(algorithm, "FCFS") == 0) {
-                    assignOrdersToPlantsFCFS(head, fileName, algorithm);
-                } else if (strcasecmp(algorithm, "SJF") == 0) {
-                    assignOrdersToPlantsSJF(head, fileName, algorithm);
-                } else {
-                    fprintf(stderr, "Invalid algorithm: '%s'\ninput is expected in the format: '[no space] | printREPORT > [filename]'", algorithm);
-                }
-            } else {
-                fprintf(stderr, "Command not recognized: '%s'\n", rest);
-            }
-        } else {
-            fprintf(stderr, "Invalid input format. Expected '[no space] | printREPORT > [filename]'.\n");
+        if (!requestsEmpty(&requests)) {
+            sched_yield();      // a push is half done
+            continue;
         }
 
-        exit(EXIT_SUCCESS); 
-    } else { // Parent process
-        close(fd[0]); 
-        write(fd[1], input, strlen(input) + 1); 
-        close(fd[1]);
-
-        wait(NULL); 
+        // announce the wait, then look once more so that a push racing with it is not missed
+        atomic_store(&requests.sleeping, 1);
+        if (!requestsEmpty(&requests)) {
+            atomic_store(&requests.sleeping, 0);
+            continue;
+        }
+        fflush(stdout);
+        while (sem_wait(&requests.wakeup) < 0 && !stopServer) {}
     }
-}
-
-// helper function to compare two dates
-int compareDates(const char* date1, const char* date2) {
 
-    int year1, month1, day1;
-    int year2, month2, day2;
-
-    sscanf(date1, "%d-%d-%d", &year1, &month1, &day1);
-    sscanf(date2, "%d-%d-%d", &year2, &month2, &day2);
-
-    if (year1 < year2) return -1;
-    if (year1 > year2) return 1;
-
-    if (month1 < month2) return -1;
-    if (month1 > month2) return 1;
-
-    if (day1 < day2) return -1;
-    if (day1 > day2) return 1;
-
-    return 0; 
+    close(listener);
+    unlink(path);
+    printf("PLS server stopped.\n");
+    return 0;
 }
 
 // main function
-int main() {
-    char command[256];
-    printf("\n~~WELCOME TO PLS~~\n\n");
-    while (1) {
-        printf("Please enter:\n> ");
-        fgets(command, sizeof(command), stdin); 
-
-        size_t lenght = strlen(command);
-        if (lenght > 0 && command[lenght - 1] == '\n') {
-            command[lenght - 1] = '\0';
-        }
-        if (strncmp(command, "addPERIOD", 9) == 0) {
-            char start_date[DATE], end_date[DATE];
-            if (sscanf(command, "addPERIOD %s %s", start_date, end_date) == 2) {
-                period(start_date, end_date);
-                calculateDays(start_date, end_date);
-            } 
-        } else if (strncmp(command, "addORDER", 8) == 0) {
-            char* line = strtok(command + 9, "\n");
-            while (line != NULL) {
-                char order_number[ORDER_ID], due_date[DATE], product_name[PRODUCT_NAME];
-                int quantity;
-                if (sscanf(line, "%s %s %d %s", order_number, due_date, &quantity, product_name) == 4) {
-
-                    order(order_number, due_date, quantity, product_name);
-                    numOrders = numOrders + 1;
-                } 
-                line = strtok(NULL, "\n");
-            }
-        } else if (strncmp(command, "addBATCH", 8) == 0) {
-            char file_name[256];
-            if (sscanf(command, "addBATCH %s", file_name) == 1) {
-                FILE* file = fopen(file_name, "r");
-                char order_number[ORDER_ID], due_date[100000], product_name[PRODUCT_NAME], command[9];
-                int quantity;
-                printf("Loading batch order from file %s\n", file_name);
-
-                while (fscanf(file, "%s %s %s %d %s", command, order_number, due_date, &quantity, product_name) == 5) {
+// (--quiet starts with traceLEVEL 0, so runs print neither rejections nor the day by day trace;
+//  --script [file] runs a command script, from stdin without a file or with '-', with no prompts;
+//  --server path serves clients on a UNIX domain socket until SIGINT or SIGTERM, after running the --script if one is given)
+int main(int argc, char* argv[]) {
+    pls_context* ctx = pls_create();
+    if (ctx == NULL) {
+        fprintf(stderr, "Out of memory.\n");
+        return 1;
+    }
+    bool script = false;
+    const char* scriptName = NULL;
+    const char* socketPath = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quiet") == 0) {
+            pls_set_trace_level(ctx, PLS_TRACE_NONE);
+        } else if (strcmp(argv[i], "--script") == 0) {
+            script = true;
+            if (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0) scriptName = argv[++i];
+        } else if (strcmp(argv[i], "--server") == 0 && i + 1 < argc) {
+            socketPath = argv[++i];
+        } else {
+            fprintf(stderr, "Unknown option: '%s'\n", argv[i]);
+        }
+    }
 
-                    order(order_number, due_date, quantity, product_name);
-                }
-                fclose(file);
-                printf("Batch file load complete.\n");
+    if (script) {
+        FILE* input = stdin;
+        if (scriptName != NULL && strcmp(scriptName, "-") != 0) {
+            input = fopen(scriptName, "r");
+            if (input == NULL) {
+                fprintf(stderr, "Error opening script file %s.\n", scriptName);
+                pls_destroy(ctx);
+                return 1;
             }
-        } else if (strncmp(command, "runPLS", 6) == 0) {
-            runPLS(command);
-        }  else if (strcmp(command, "exitPLS") == 0) {
-            while (head != NULL) {
-                Order* temp = head;
-                head = head->next;
-                free(temp);
-            }
-            printf("Exiting PLS.....\nWARNING: Order History Cleared\n");
-            break;
-        }else if(strcmp(command, "print") == 0){
-            printOrderHistory();
         }
-        else {
-            fprintf(stderr, "WRONG COMMAND.\n");
-        } 
+        runScript(ctx, input);
+        if (socketPath == NULL) {
+            pls_destroy(ctx);
+            return 0;
+        }
     }
+    if (socketPath != NULL) {
+        int status = runServer(ctx, socketPath);
+        pls_destroy(ctx);
+        return status;
+    }
+
+    printf("\n~~WELCOME TO PLS~~\n\n");
+    runLines(ctx, stdin, true);
+    pls_destroy(ctx);
+    printf("Exiting PLS.....\nWARNING: Order History Cleared\n");
     return 0;
 }
-
-
@@ -0,0 +1,4150 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "pls.h"
+
+// constant values
+#define ARENA_BLOCK (1 << 20)
+#define OUTPUT_BUFFER (1 << 20)
+#define MAX_CHANGEOVER 365
+#define OPT_THREADS 64
+#define MAX_OPT_BUDGET 3600000
+#define CACHE_ENTRIES 8
+
+// a block of memory owned by an arena
+typedef struct ArenaBlock {
+    struct ArenaBlock* next;
+    size_t used, size;
+    max_align_t data[];
+} ArenaBlock;
+
+// a structure for an arena that hands out memory from large blocks and releases it all in one step
+typedef struct Arena {
+    ArenaBlock* blocks;
+} Arena;
+
+// a structure for the orders in the system, stored column by column (row i of every column is order i)
+typedef struct OrderTable {
+    int count, capacity;
+    char (*order_number)[ORDER_ID];
+    int* due_day;
+    int* quantity;
+    int* product_id;
+    int* index;             // open-addressing hash index over order_number holding row + 1, 0 for an empty slot
+    size_t indexCapacity;
+} OrderTable;
+
+// a structure for the interned product names (an order stores the row of its product here)
+typedef struct ProductTable {
+    int count, capacity;
+    char (*name)[PRODUCT_NAME];
+    int* index;
+    size_t indexCapacity;
+} ProductTable;
+
+// a structure for a run of consecutive days that a plant spends on one order
+typedef struct Segment {
+    int plant, order;           // plant index and order row
+    int start_day, run_length;  // first day (counted from the start of the period) and number of days
+    int units;                  // units produced on each of those days
+} Segment;
+
+// a structure for the first day of an SJF allocation and the largest remaining quantity it picked
+typedef struct Step {
+    int day, largest;
+} Step;
+
+// a structure for a run-length encoded schedule and the outcome of the run that produced it
+// (it also keeps what a later run needs to extend it when only new orders have come in)
+typedef struct Schedule {
+    Segment* segments;
+    int count, capacity;
+    int plantCount;
+    int* plantOrder;            // order in which the plants pick their order each day
+    int* lastSegment;           // latest segment of each plant, so a continuing run is extended instead of repeated
+    int* days;                  // days each plant is in use
+    int* produce;               // units each plant produces
+    int orderCount;             // orders the run was given
+    int* rejected;              // rows of the orders turned away by the admission check
+    int rejectedCount, rejectedCapacity;
+    double seconds;             // wall time of the run
+    char algorithm[8];          // algorithm that built the schedule, empty when it cannot be extended
+    int setup;                  // version of the plants and period it was built for
+    long long* dueKeys;         // sorted sortKey(due day, row) keys of its orders
+    int* sequence;              // accepted rows in the order the algorithm took them
+    int sequenceCount, orderCapacity;
+    int idleDay;                // first day a plant was left without an order, INT_MAX if none
+    Step* steps;                // SJF allocations in day order
+    int stepCount, stepCapacity;
+} Schedule;
+
+// a structure for a schedule kept by the schedule cache, with the fingerprint of the inputs it was built from
+typedef struct CacheEntry {
+    uint64_t key;
+    Schedule schedule;          // its algorithm is empty while the entry is free
+    long long lastUsed;
+} CacheEntry;
+
+// a structure for an improvement found by an OPT run
+typedef struct ConvergencePoint {
+    double seconds;             // since the run started
+    long long onTime, produced;
+    int plantDays;
+    int worker;                 // search thread that found it, -1 for the best starting schedule
+} ConvergencePoint;
+
+// a structure for the improvements of the last OPT run, in the order they were found
+typedef struct Convergence {
+    ConvergencePoint* points;
+    int count, capacity;
+} Convergence;
+
+// phases timed by the statistics
+enum { PHASE_ORDER, PHASE_BATCH, PHASE_ADMISSION, PHASE_RUN, PHASE_TRACE, PHASE_REPORT, PHASE_SNAPSHOT, PHASE_COUNT };
+#define HISTOGRAM_BUCKETS 32
+
+// a structure for the timers, counters and histograms of a context (only filled in while enabled)
+typedef struct Stats {
+    bool enabled;
+    long long calls[PHASE_COUNT];
+    long long nanoseconds[PHASE_COUNT], maxNanoseconds[PHASE_COUNT];
+    long long histogram[PHASE_COUNT][HISTOGRAM_BUCKETS];   // bucket 0 counts calls under 1 us, bucket i those of 2^(i-1) to 2^i us
+    long long ordersAdded, ordersScanned, ordersAdmitted;
+    long long allocations;      // order to plant pairings made by the scheduling loops
+    long long rounds;           // allocation rounds, each covering one or more identical days
+    long long daysCovered;      // days covered by those rounds
+    long long runsExtended;     // runs that kept part of the previous schedule
+    long long daysReused;       // days those runs kept
+    long long bytesWritten;     // bytes of traces and reports
+    long long cacheHits, cacheDiskHits, cacheMisses;    // runs answered from the schedule cache (in memory or on disk) or not
+} Stats;
+
+// a structure for a stretch of days on which a plant does not work: maintenance of one plant, or a holiday of them all
+typedef struct Downtime {
+    int plant;                  // plant index, -1 for a holiday
+    int first_day, last_day;    // both included
+} Downtime;
+
+// a structure for the read-only view of the orders, plants and period that a scheduling run works from
+typedef struct Snapshot {
+    int orderCount;
+    const int* due_day;
+    const int* quantity;
+    const int* product_id;
+    int productCount;
+    int plantCount;
+    const int* capacity;
+    const Downtime* downtime;   // plant calendar, in the order it was entered
+    int downtimeCount;
+    int start_day, numDays;
+    int setup;                  // version of the plants and period
+    int changeover;             // idle days a plant spends switching products in a GROUP run
+    const long long* dueKeys;   // sorted sortKey(due day, row) keys of every order shared by several runs, NULL to sort them
+    int optBudget;              // milliseconds an OPT run searches for
+    Convergence* convergence;   // where an OPT run records its improvements, NULL if nobody wants them
+    Stats* stats;               // where the run adds its figures, NULL while statistics are off
+} Snapshot;
+
+// a structure for the scheduling period
+typedef struct Period {
+    char start_date[DATE], end_date[DATE];
+    int start_day, end_day;
+} Period;
+
+// a structure for the plants, stored column by column (row i of every column is plant i)
+typedef struct PlantTable {
+    int count, allocated;
+    char (*name)[PLANT_NAME];
+    int* capacity;              // units per day
+} PlantTable;
+
+// a structure for everything a scheduling context owns
+struct pls_context {
+    Arena orderArena;
+    OrderTable orders;
+    uint64_t orderHash;         // fingerprint of the orders in arrival order, updated as each one is added
+    ProductTable products;
+    Period period;
+    int numberOfDays;
+    PlantTable plants;
+    Downtime* downtime;         // plant calendar
+    int downtimeCount, downtimeCapacity;
+    int setup;                  // bumped whenever the plants, the calendar or the period change or the orders are cleared
+    Schedule lastSchedule;
+    char lastAlgorithm[8];      // algorithm of the last schedule, empty before the first run
+    bool cacheEnabled;          // whether runs keep and reuse schedules by the fingerprint of their inputs
+    CacheEntry cache[CACHE_ENTRIES];
+    long long cacheClock;       // stamps the entries so the least recently used one is replaced
+    char cacheDir[256];         // directory the cached schedules are also written to, empty for none
+    void* snapshotMap;          // mapped snapshot file the order and product columns point into, NULL if none
+    size_t snapshotSize;
+    int changeover;             // idle days a plant spends switching products in a GROUP run
+    int optBudget;              // milliseconds an OPT run searches for
+    Convergence convergence;    // improvements of the last OPT run
+    FILE* messages;
+    int traceLevel;             // PLS_TRACE_NONE, PLS_TRACE_REJECTIONS or PLS_TRACE_DAYS
+    int reportFormat;           // PLS_REPORT_TEXT, PLS_REPORT_CSV or PLS_REPORT_TSV
+    char* outputBuffer;         // reused by every report and trace, allocated on first use
+    pthread_mutex_t reportLock; // guards the report queue, the finished list and the pending count
+    pthread_cond_t reportChanged;
+    pthread_t reportThread;
+    bool reportThreadStarted, reportStop;
+    struct ReportJob* reportQueue;  // reports waiting for the background writer, the one being written first
+    struct ReportJob* reportsDone;  // reports written but whose outcome has not been printed yet
+    int reportsPending;
+    char* reportBuffer;         // output buffer of the background writer
+    Stats stats;
+    char statsFile[256];        // file the statistics are appended to after every run, empty for none
+};
+
+// helper function to print a message of a context to its message stream
+__attribute__((format(printf, 2, 3)))
+static void message(pls_context* ctx, const char* format, ...) {
+    if (ctx->messages == NULL) return;
+
+    va_list arguments;
+    va_start(arguments, format);
+    vfprintf(ctx->messages, format, arguments);
+    va_end(arguments);
+}
+
+// helper function to get the statistics of a context, NULL while they are off
+static Stats* activeStats(pls_context* ctx) {
+    return ctx->stats.enabled ? &ctx->stats : NULL;
+}
+
+// helper function to read the clock at the start of a timed phase (the clock is not read while statistics are off)
+static void statsStart(const Stats* stats, struct timespec* start) {
+    if (stats != NULL) clock_gettime(CLOCK_MONOTONIC, start);
+}
+
+// helper function to add one timed call of a phase to the statistics
+static void statsRecord(Stats* stats, int phase, long long elapsed) {
+    if (stats == NULL) return;
+
+    stats->calls[phase]++;
+    stats->nanoseconds[phase] += elapsed;
+    if (elapsed > stats->maxNanoseconds[phase]) stats->maxNanoseconds[phase] = elapsed;
+    int bucket = 0;
+    for (long long micro = elapsed / 1000; micro > 0 && bucket < HISTOGRAM_BUCKETS - 1; micro >>= 1) bucket++;
+    stats->histogram[phase][bucket]++;
+}
+
+// helper function to add the time since statsStart to a phase
+static void statsStop(Stats* stats, int phase, const struct timespec* start) {
+    if (stats == NULL) return;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    statsRecord(stats, phase, (long long)(now.tv_sec - start->tv_sec) * 1000000000LL + (now.tv_nsec - start->tv_nsec));
+}
+
+// helper function to add the figures of one set of statistics to another
+static void mergeStats(Stats* into, const Stats* from) {
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        into->calls[phase] += from->calls[phase];
+        into->nanoseconds[phase] += from->nanoseconds[phase];
+        if (from->maxNanoseconds[phase] > into->maxNanoseconds[phase]) into->maxNanoseconds[phase] = from->maxNanoseconds[phase];
+        for (int bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++) into->histogram[phase][bucket] += from->histogram[phase][bucket];
+    }
+    into->ordersAdded += from->ordersAdded;
+    into->ordersScanned += from->ordersScanned;
+    into->ordersAdmitted += from->ordersAdmitted;
+    into->allocations += from->allocations;
+    into->rounds += from->rounds;
+    into->daysCovered += from->daysCovered;
+    into->runsExtended += from->runsExtended;
+    into->daysReused += from->daysReused;
+    into->bytesWritten += from->bytesWritten;
+    into->cacheHits += from->cacheHits;
+    into->cacheDiskHits += from->cacheDiskHits;
+    into->cacheMisses += from->cacheMisses;
+}
+
+// function to print the statistics of a context
+static void printStats(const pls_context* ctx, FILE* stream) {
+    static const char* const phaseNames[PHASE_COUNT] = {"order", "batch", "admission", "run", "trace", "report", "snapshot"};
+    const Stats* stats = &ctx->stats;
+
+    fprintf(stream, "***PLS Statistics*** (collection %s)\n", stats->enabled ? "on" : "off");
+    fprintf(stream, "PHASE CALLS TOTAL(ms) MEAN(us) MAX(us)\n");
+    fprintf(stream, "===========================================================================\n");
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        if (stats->calls[phase] == 0) continue;
+        fprintf(stream, "%s %lld %.3f %.3f %.3f\n", phaseNames[phase], stats->calls[phase], stats->nanoseconds[phase] / 1e6,
+            stats->nanoseconds[phase] / 1e3 / stats->calls[phase], stats->maxNanoseconds[phase] / 1e3);
+    }
+    fprintf(stream, "(admission is part of run)\n\n");
+
+    fprintf(stream, "Orders added: %lld\n", stats->ordersAdded);
+    fprintf(stream, "Orders scanned by admission: %lld\n", stats->ordersScanned);
+    fprintf(stream, "Orders admitted: %lld\n", stats->ordersAdmitted);
+    fprintf(stream, "Allocations made: %lld\n", stats->allocations);
+    fprintf(stream, "Allocation rounds: %lld (covering %lld days)\n", stats->rounds, stats->daysCovered);
+    fprintf(stream, "Runs extended from the last schedule: %lld (reusing %lld days)\n", stats->runsExtended, stats->daysReused);
+    fprintf(stream, "Schedule cache: %lld hits (%lld from disk), %lld misses\n", stats->cacheHits, stats->cacheDiskHits, stats->cacheMisses);
+    fprintf(stream, "Trace and report bytes written: %lld\n\n", stats->bytesWritten);
+
+    fprintf(stream, "HISTOGRAMS (calls per duration in us)\n");
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        if (stats->calls[phase] == 0) continue;
+        fprintf(stream, "%s:", phaseNames[phase]);
+        for (int bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++) {
+            if (stats->histogram[phase][bucket] == 0) continue;
+            if (bucket == 0) {
+                fprintf(stream, " <1:%lld", stats->histogram[phase][bucket]);
+            } else {
+                fprintf(stream, " %lld-%lld:%lld", 1LL << (bucket - 1), 1LL << bucket, stats->histogram[phase][bucket]);
+            }
+        }
+        fprintf(stream, "\n");
+    }
+    fprintf(stream, "- End -\n");
+}
+
+// helper function to append the statistics to the statistics file of the context after a run
+static void dumpStats(pls_context* ctx, const char* algorithm) {
+    if (ctx->statsFile[0] == '\0') return;
+
+    FILE* file = fopen(ctx->statsFile, "a");
+    if (file == NULL) {
+        message(ctx, "Error opening statistics file %s.\n", ctx->statsFile);
+        return;
+    }
+    fprintf(file, "After runPLS %s:\n", algorithm);
+    printStats(ctx, file);
+    fprintf(file, "\n");
+    fclose(file);
+}
+
+
+// helper function to turn a day number back into a YYYY-MM-DD date
+static void formatDate(int day, char* text) {
+    // civil date from days, counting years from March so the leap day is the last day of the year
+    day += 719468;
+    int era = (day >= 0 ? day : day - 146096) / 146097;
+    int dayOfEra = day - era * 146097;
+    int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int monthIndex = (5 * dayOfYear + 2) / 153;
+    int mday = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+    int month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+    int year = yearOfEra + era * 400 + (month <= 2);
+    int fields[3] = {year, month, mday};
+    const int widths[3] = {4, 2, 2};
+    char* cursor = text;
+    for (int i = 0; i < 3; i++) {
+        for (int k = widths[i] - 1; k >= 0; k--) {
+            cursor[k] = (char)('0' + fields[i] % 10);
+            fields[i] /= 10;
+        }
+        cursor += widths[i];
+        *cursor++ = i < 2 ? '-' : '\0';
+    }
+}
+
+// function for checking if order is added and batch file is added
+static void printOrderHistory(pls_context* ctx) {
+
+    if (ctx->orders.count == 0) {
+
+        message(ctx, "No Order in the history.\n");
+        return;
+    }
+    
+    message(ctx, "Order History:\n");
+    message(ctx, "%-10s | %-10s | %-8s | %-20s\n", "Order ID", "Due Date", "Quantity", "Product Name");
+    message(ctx, "-------------------------------------------------\n");
+    
+    for (int row = 0; row < ctx->orders.count; row++) {
+        char due_date[DATE];
+        formatDate(ctx->orders.due_day[row], due_date);
+        message(ctx, "%-10s | %-10s | %-8d | %-20s\n",
+               ctx->orders.order_number[row],
+               due_date,
+               ctx->orders.quantity[row],
+               ctx->products.name[ctx->orders.product_id[row]]);
+    }
+}
+
+// helper function to parse a fixed-format YYYY-MM-DD date into a day number (days since 1970-01-01)
+static bool parseDate(const char* text, size_t length, int* day) {
+    if (length != 10 || text[4] != '-' || text[7] != '-') return false;
+
+    int digits[8];
+    const int positions[8] = {0, 1, 2, 3, 5, 6, 8, 9};
+    for (int i = 0; i < 8; i++) {
+        unsigned digit = (unsigned)(text[positions[i]] - '0');
+        if (digit > 9) return false;
+        digits[i] = (int)digit;
+    }
+
+    int year = digits[0] * 1000 + digits[1] * 100 + digits[2] * 10 + digits[3];
+    int month = digits[4] * 10 + digits[5];
+    int mday = digits[6] * 10 + digits[7];
+    static const int monthDays[12] = {31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (month < 1 || month > 12 || mday < 1 || mday > monthDays[month - 1]) return false;
+    if (month == 2 && mday == 29 && !(year % 4 == 0 && (year % 100 != 0 || year % 400 == 0))) return false;
+
+    // days from civil date, counting years from March so the leap day is the last day of the year
+    year -= month <= 2;
+    int era = (year >= 0 ? year : year - 399) / 400;
+    int yearOfEra = year - era * 400;
+    int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + mday - 1;
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    *day = era * 146097 + dayOfEra - 719468;
+    return true;
+}
+
+// function to add scheduling period
+static bool period(pls_context* ctx, const char* start_date, const char* end_date) {
+    int start_day, end_day;
+
+    if (!parseDate(start_date, strlen(start_date), &start_day)) {
+        message(ctx, "Error parsing start date.\n");
+        return false;
+    }
+    if (!parseDate(end_date, strlen(end_date), &end_day)) {
+        message(ctx, "Error parsing end date.\n");
+        return false;
+    }
+
+    strcpy(ctx->period.start_date, start_date);
+    strcpy(ctx->period.end_date, end_date);
+    ctx->period.start_day = start_day;
+    ctx->period.end_day = end_day;
+    ctx->setup++;
+    message(ctx, "Scheduling period set succesfully (%s to %s)\n", start_date, end_date);
+    return true;
+}
+
+// function to calculate the number of days in the scheduling period 
+static void calculateDays(pls_context* ctx) {
+    ctx->numberOfDays = ctx->period.end_day - ctx->period.start_day;
+}
+
+
+// helper function to hand out aligned memory from the arena, starting a new block when the current one is full
+static void* arenaAlloc(Arena* arena, size_t size) {
+    size = (size + sizeof(max_align_t) - 1) & ~(sizeof(max_align_t) - 1);
+
+    ArenaBlock* block = arena->blocks;
+    if (block == NULL || block->size - block->used < size) {
+        size_t blockSize = size > ARENA_BLOCK / 4 ? size : ARENA_BLOCK;
+        block = (ArenaBlock*)malloc(sizeof(ArenaBlock) + blockSize);
+        if (block == NULL) return NULL;
+        block->used = 0;
+        block->size = blockSize;
+        // a dedicated block for a large request goes behind the current one so its free space is kept
+        if (size > ARENA_BLOCK / 4 && arena->blocks != NULL) {
+            block->next = arena->blocks->next;
+            arena->blocks->next = block;
+        } else {
+            block->next = arena->blocks;
+            arena->blocks = block;
+        }
+    }
+
+    void* memory = (char*)block->data + block->used;
+    block->used += size;
+    return memory;
+}
+
+// helper function to release every block of the arena at once
+static void arenaFree(Arena* arena) {
+    while (arena->blocks != NULL) {
+        ArenaBlock* next = arena->blocks->next;
+        free(arena->blocks);
+        arena->blocks = next;
+    }
+}
+
+// helper function to hash a name (FNV-1a)
+static size_t hashName(const char* name) {
+    size_t hash = 14695981039346656037ULL;
+    while (*name) {
+        hash ^= (unsigned char)*name++;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// helper function to find the slot of a name in a hash index (either its entry or the empty slot where it belongs)
+// the index holds row + 1 of the fixed-width key column it covers
+static size_t findSlot(const int* index, size_t capacity, const char* keys, size_t keySize, const char* name) {
+    size_t mask = capacity - 1;
+    size_t slot = hashName(name) & mask;
+    while (index[slot] != 0 && strcmp(keys + (size_t)(index[slot] - 1) * keySize, name) != 0) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+// helper function to rebuild a hash index twice as large (kept at most half full, linear probing)
+static bool growIndex(Arena* arena, int** index, size_t* capacity, const char* keys, size_t keySize, int count) {
+    size_t newCapacity = *capacity == 0 ? 1024 : *capacity * 2;
+    int* newIndex = (int*)arenaAlloc(arena, newCapacity * sizeof(int));
+    if (newIndex == NULL) {
+        return false;
+    }
+    memset(newIndex, 0, newCapacity * sizeof(int));
+
+    for (int row = 0; row < count; row++) {
+        newIndex[findSlot(newIndex, newCapacity, keys, keySize, keys + (size_t)row * keySize)] = row + 1;
+    }
+
+    *index = newIndex;
+    *capacity = newCapacity;
+    return true;
+}
+
+// helper function to look up an order by its number, -1 if it is not in the system
+static int findOrder(pls_context* ctx, const char* order_number) {
+    if (ctx->orders.count == 0) return -1;
+    return ctx->orders.index[findSlot(ctx->orders.index, ctx->orders.indexCapacity, (const char*)ctx->orders.order_number, ORDER_ID, order_number)] - 1;
+}
+
+// helper function to double the columns of the order table
+// (the old columns stay in the arena until exitPLS, which bounds the waste to the size of the table)
+static bool growOrders(pls_context* ctx) {
+    int newCapacity = ctx->orders.capacity == 0 ? 1024 : ctx->orders.capacity * 2;
+    char (*order_number)[ORDER_ID] = arenaAlloc(&ctx->orderArena, (size_t)newCapacity * ORDER_ID);
+    int* due_day = (int*)arenaAlloc(&ctx->orderArena, (size_t)newCapacity * sizeof(int));
+    int* quantity = (int*)arenaAlloc(&ctx->orderArena, (size_t)newCapacity * sizeof(int));
+    int* product_id = (int*)arenaAlloc(&ctx->orderArena, (size_t)newCapacity * sizeof(int));
+    if (order_number == NULL || due_day == NULL || quantity == NULL || product_id == NULL) {
+        return false;
+    }
+
+    if (ctx->orders.count > 0) {
+        memcpy(order_number, ctx->orders.order_number, (size_t)ctx->orders.count * ORDER_ID);
+        memcpy(due_day, ctx->orders.due_day, (size_t)ctx->orders.count * sizeof(int));
+        memcpy(quantity, ctx->orders.quantity, (size_t)ctx->orders.count * sizeof(int));
+        memcpy(product_id, ctx->orders.product_id, (size_t)ctx->orders.count * sizeof(int));
+    }
+
+    ctx->orders.order_number = order_number;
+    ctx->orders.due_day = due_day;
+    ctx->orders.quantity = quantity;
+    ctx->orders.product_id = product_id;
+    ctx->orders.capacity = newCapacity;
+    return true;
+}
+
+// helper function to get the id of a product name, adding it to the product table the first time it is seen
+static int internProduct(pls_context* ctx, const char* product_name) {
+    if (ctx->products.count > 0) {
+        int row = ctx->products.index[findSlot(ctx->products.index, ctx->products.indexCapacity, (const char*)ctx->products.name, PRODUCT_NAME, product_name)] - 1;
+        if (row >= 0) return row;
+    }
+
+    if (ctx->products.count == ctx->products.capacity) {
+        int newCapacity = ctx->products.capacity == 0 ? 64 : ctx->products.capacity * 2;
+        char (*name)[PRODUCT_NAME] = arenaAlloc(&ctx->orderArena, (size_t)newCapacity * PRODUCT_NAME);
+        if (name == NULL) return -1;
+        if (ctx->products.count > 0) memcpy(name, ctx->products.name, (size_t)ctx->products.count * PRODUCT_NAME);
+        ctx->products.name = name;
+        ctx->products.capacity = newCapacity;
+    }
+    if ((size_t)(ctx->products.count + 1) * 2 > ctx->products.indexCapacity &&
+        !growIndex(&ctx->orderArena, &ctx->products.index, &ctx->products.indexCapacity, (const char*)ctx->products.name, PRODUCT_NAME, ctx->products.count)) {
+        return -1;
+    }
+
+    int row = ctx->products.count++;
+    strcpy(ctx->products.name[row], product_name);
+    ctx->products.index[findSlot(ctx->products.index, ctx->products.indexCapacity, (const char*)ctx->products.name, PRODUCT_NAME, product_name)] = row + 1;
+    return row;
+}
+
+// helper function to fold an order into the fingerprint of the orders before it
+// (FNV-1a over the order number, due day, quantity and product name, so any change to the book gives a new fingerprint)
+static uint64_t hashOrder(const pls_context* ctx, uint64_t hash, int row) {
+    int fields[2] = {ctx->orders.due_day[row], ctx->orders.quantity[row]};
+    const char* names[2] = {ctx->orders.order_number[row], ctx->products.name[ctx->orders.product_id[row]]};
+    for (int i = 0; i < 2; i++) {
+        for (const char* c = names[i]; ; c++) {
+            hash = (hash ^ (unsigned char)*c) * 1099511628211ULL;
+            if (*c == '\0') break;
+        }
+    }
+    const unsigned char* bytes = (const unsigned char*)fields;
+    for (size_t i = 0; i < sizeof(fields); i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+// helper function to add an order whose due date has already been parsed into a day number
+static bool insertOrder(pls_context* ctx, const char* order_number, int due_day, int quantity, const char* product_name) {
+
+    if (findOrder(ctx, order_number) >= 0) {
+        message(ctx, "Order number: %s already exists. Duplicate not added.\n", order_number);
+        return false;
+    }
+
+    if ((ctx->orders.count == ctx->orders.capacity && !growOrders(ctx)) ||
+        ((size_t)(ctx->orders.count + 1) * 2 > ctx->orders.indexCapacity &&
+         !growIndex(&ctx->orderArena, &ctx->orders.index, &ctx->orders.indexCapacity, (const char*)ctx->orders.order_number, ORDER_ID, ctx->orders.count))) {
+        message(ctx, "Out of memory. Order %s not added.\n", order_number);
+        return false;
+    }
+
+    int product_id = internProduct(ctx, product_name);
+    if (product_id < 0) {
+        message(ctx, "Out of memory. Order %s not added.\n", order_number);
+        return false;
+    }
+
+    int row = ctx->orders.count++;
+    strcpy(ctx->orders.order_number[row], order_number);
+    ctx->orders.due_day[row] = due_day;
+    ctx->orders.quantity[row] = quantity;
+    ctx->orders.product_id[row] = product_id;
+    ctx->orders.index[findSlot(ctx->orders.index, ctx->orders.indexCapacity, (const char*)ctx->orders.order_number, ORDER_ID, order_number)] = row + 1;
+    ctx->orderHash = hashOrder(ctx, ctx->orderHash, row);
+    if (ctx->stats.enabled) ctx->stats.ordersAdded++;
+
+    message(ctx, "Order Successful (%s).\n", order_number);
+    return true;
+}
+
+// function to add an order or multiple lines of order
+static bool order(pls_context* ctx, const char* order_number, const char* due_date, int quantity, const char* product_name) {
+    int due_day;
+    if (!parseDate(due_date, strlen(due_date), &due_day)) {
+        message(ctx, "Invalid due date %s. Order %s not added.\n", due_date, order_number);
+        return false;
+    }
+    return insertOrder(ctx, order_number, due_day, quantity, product_name);
+}
+
+// function to drop every order and product in one step
+static void clearOrders(pls_context* ctx) {
+    arenaFree(&ctx->orderArena);
+    if (ctx->snapshotMap != NULL) {
+        munmap(ctx->snapshotMap, ctx->snapshotSize);
+        ctx->snapshotMap = NULL;
+    }
+    memset(&ctx->orders, 0, sizeof(ctx->orders));
+    memset(&ctx->products, 0, sizeof(ctx->products));
+    ctx->orderHash = 14695981039346656037ULL;
+    ctx->setup++;
+}
+
+// helper function to skip blanks within a line of the batch file
+static const char* skipBlanks(const char* cursor, const char* lineEnd) {
+    while (cursor < lineEnd && (*cursor == ' ' || *cursor == '\t' || *cursor == '\r')) cursor++;
+    return cursor;
+}
+
+// helper function to find the end of the token starting at the cursor
+static const char* tokenEnd(const char* cursor, const char* lineEnd) {
+    while (cursor < lineEnd && *cursor != ' ' && *cursor != '\t' && *cursor != '\r') cursor++;
+    return cursor;
+}
+
+// helper function to parse one "addORDER <id> <due date> <quantity> <product>" line of a batch file
+static bool parseBatchLine(const char* cursor, const char* lineEnd, char* order_number, int* due_day, int* quantity, char* product_name) {
+    const char* tokens[5];
+    size_t lengths[5];
+    for (int i = 0; i < 5; i++) {
+        cursor = skipBlanks(cursor, lineEnd);
+        if (cursor == lineEnd) return false;
+        tokens[i] = cursor;
+        cursor = tokenEnd(cursor, lineEnd);
+        lengths[i] = (size_t)(cursor - tokens[i]);
+    }
+    if (skipBlanks(cursor, lineEnd) != lineEnd) return false;
+
+    if (lengths[0] != 8 || memcmp(tokens[0], "addORDER", 8) != 0) return false;
+    if (lengths[1] >= ORDER_ID || lengths[4] >= PRODUCT_NAME) return false;
+
+    if (!parseDate(tokens[2], lengths[2], due_day)) return false;
+
+    int value = 0;
+    for (size_t i = 0; i < lengths[3]; i++) {
+        unsigned digit = (unsigned)(tokens[3][i] - '0');
+        if (digit > 9 || value > (__INT_MAX__ - (int)digit) / 10) return false;
+        value = value * 10 + (int)digit;
+    }
+    if (value <= 0) return false;
+
+    memcpy(order_number, tokens[1], lengths[1]);
+    order_number[lengths[1]] = '\0';
+    memcpy(product_name, tokens[4], lengths[4]);
+    product_name[lengths[4]] = '\0';
+    *quantity = value;
+    return true;
+}
+
+// function to load a batch file of orders by mapping it into memory and scanning it in place
+static bool loadBatch(pls_context* ctx, const char* file_name) {
+    int fd = open(file_name, O_RDONLY);
+    if (fd < 0) {
+        message(ctx, "Error opening batch file %s.\n", file_name);
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) < 0) {
+        message(ctx, "Error reading batch file %s.\n", file_name);
+        close(fd);
+        return false;
+    }
+
+    message(ctx, "Loading batch order from file %s\n", file_name);
+    if (info.st_size == 0) {
+        close(fd);
+        message(ctx, "Batch file load complete.\n");
+        return true;
+    }
+
+    size_t size = (size_t)info.st_size;
+    const char* data = (const char*)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        message(ctx, "Error mapping batch file %s.\n", file_name);
+        return false;
+    }
+    madvise((void*)data, size, MADV_SEQUENTIAL);
+
+    const char* end = data + size;
+    const char* cursor = data;
+    size_t lineNumber = 0;
+    int malformed = 0;
+    while (cursor < end) {
+        const char* lineEnd = (const char*)memchr(cursor, '\n', (size_t)(end - cursor));
+        if (lineEnd == NULL) lineEnd = end;
+        lineNumber++;
+
+        if (skipBlanks(cursor, lineEnd) != lineEnd) {
+            char order_number[ORDER_ID], product_name[PRODUCT_NAME];
+            int due_day, quantity;
+            if (parseBatchLine(cursor, lineEnd, order_number, &due_day, &quantity, product_name)) {
+                insertOrder(ctx, order_number, due_day, quantity, product_name);
+            } else {
+                message(ctx, "Line %zu of %s is malformed and was skipped.\n", lineNumber, file_name);
+                malformed++;
+            }
+        }
+        cursor = lineEnd + 1;
+    }
+
+    munmap((void*)data, size);
+    if (malformed > 0) {
+        message(ctx, "Batch file load complete (%d malformed lines skipped).\n", malformed);
+    } else {
+        message(ctx, "Batch file load complete.\n");
+    }
+    return true;
+}
+
+// helper function to find the index of the largest value (the first one on ties)
+static int argmaxInt(const int* values, int count) {
+    if (count <= 0) return -1;
+
+    int best = values[0];
+    int i = 1;
+#if defined(__SSE2__)
+    if (count >= 8) {
+        __m128i maxima = _mm_loadu_si128((const __m128i*)values);
+        for (i = 4; i + 4 <= count; i += 4) {
+            __m128i chunk = _mm_loadu_si128((const __m128i*)(values + i));
+            __m128i greater = _mm_cmpgt_epi32(chunk, maxima);
+            maxima = _mm_or_si128(_mm_and_si128(greater, chunk), _mm_andnot_si128(greater, maxima));
+        }
+        int lanes[4];
+        _mm_storeu_si128((__m128i*)lanes, maxima);
+        best = lanes[0];
+        for (int k = 1; k < 4; k++) {
+            if (lanes[k] > best) best = lanes[k];
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        if (values[i] > best) best = values[i];
+    }
+
+    // first position holding the maximum
+    i = 0;
+#if defined(__SSE2__)
+    __m128i target = _mm_set1_epi32(best);
+    for (; i + 4 <= count; i += 4) {
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(values + i)), target)));
+        if (mask != 0) return i + __builtin_ctz((unsigned)mask);
+    }
+#endif
+    while (values[i] != best) i++;
+    return i;
+}
+
+// helper function to find the index of the smallest value (the first one on ties)
+static int argminInt(const int* values, int count) {
+    if (count <= 0) return -1;
+
+    int best = values[0];
+    int i = 1;
+#if defined(__SSE2__)
+    if (count >= 8) {
+        __m128i minima = _mm_loadu_si128((const __m128i*)values);
+        for (i = 4; i + 4 <= count; i += 4) {
+            __m128i chunk = _mm_loadu_si128((const __m128i*)(values + i));
+            __m128i less = _mm_cmplt_epi32(chunk, minima);
+            minima = _mm_or_si128(_mm_and_si128(less, chunk), _mm_andnot_si128(less, minima));
+        }
+        int lanes[4];
+        _mm_storeu_si128((__m128i*)lanes, minima);
+        best = lanes[0];
+        for (int k = 1; k < 4; k++) {
+            if (lanes[k] < best) best = lanes[k];
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        if (values[i] < best) best = values[i];
+    }
+
+    // first position holding the minimum
+    i = 0;
+#if defined(__SSE2__)
+    __m128i target = _mm_set1_epi32(best);
+    for (; i + 4 <= count; i += 4) {
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(values + i)), target)));
+        if (mask != 0) return i + __builtin_ctz((unsigned)mask);
+    }
+#endif
+    while (values[i] != best) i++;
+    return i;
+}
+
+// helper function to look up a plant by its name, -1 if there is no such plant
+static int findPlant(pls_context* ctx, const char* name) {
+    for (int i = 0; i < ctx->plants.count; i++) {
+        if (strcmp(ctx->plants.name[i], name) == 0) return i;
+    }
+    return -1;
+}
+
+// helper function to append a plant to the plant table, returns its row or -1 when out of memory
+static int appendPlant(pls_context* ctx, const char* name, int capacity) {
+    if (ctx->plants.count == ctx->plants.allocated) {
+        int allocated = ctx->plants.allocated == 0 ? 8 : ctx->plants.allocated * 2;
+        char (*names)[PLANT_NAME] = realloc(ctx->plants.name, (size_t)allocated * PLANT_NAME);
+        if (names != NULL) ctx->plants.name = names;
+        int* capacity = (int*)realloc(ctx->plants.capacity, sizeof(int) * (size_t)allocated);
+        if (capacity != NULL) ctx->plants.capacity = capacity;
+        if (names == NULL || capacity == NULL) return -1;
+        ctx->plants.allocated = allocated;
+    }
+
+    int row = ctx->plants.count++;
+    strcpy(ctx->plants.name[row], name);
+    ctx->plants.capacity[row] = capacity;
+    return row;
+}
+
+// function to add a plant, or to change the capacity of a plant that already exists
+static bool plant(pls_context* ctx, const char* name, int capacity) {
+    if (capacity <= 0 || strlen(name) >= PLANT_NAME) {
+        message(ctx, "Invalid plant %s with capacity %d.\n", name, capacity);
+        return false;
+    }
+
+    int row = findPlant(ctx, name);
+    if (row >= 0) {
+        ctx->plants.capacity[row] = capacity;
+        ctx->setup++;
+        message(ctx, "Plant %s capacity set to %d per day.\n", name, capacity);
+        return true;
+    }
+
+    if (appendPlant(ctx, name, capacity) < 0) {
+        message(ctx, "Out of memory. Plant %s not added.\n", name);
+        return false;
+    }
+    ctx->setup++;
+    message(ctx, "Plant %s added with capacity %d per day.\n", name, capacity);
+    return true;
+}
+
+// function to set up the three plants the factory starts with
+static void defaultPlants(pls_context* ctx) {
+    appendPlant(ctx, "Plant_X", 300);
+    appendPlant(ctx, "Plant_Y", 400);
+    appendPlant(ctx, "Plant_Z", 500);
+}
+
+// function to release the plant table
+static void clearPlants(pls_context* ctx) {
+    free(ctx->plants.name);
+    free(ctx->plants.capacity);
+    memset(&ctx->plants, 0, sizeof(ctx->plants));
+}
+
+// function to add a stretch of days on which a plant (or every plant, for -1) does not work
+static bool addDowntime(pls_context* ctx, int plant, const char* first_date, const char* last_date) {
+    int first_day, last_day;
+    if (!parseDate(first_date, strlen(first_date), &first_day) || !parseDate(last_date, strlen(last_date), &last_day) || last_day < first_day) {
+        message(ctx, "Invalid downtime from %s to %s.\n", first_date, last_date);
+        return false;
+    }
+
+    if (ctx->downtimeCount == ctx->downtimeCapacity) {
+        int newCapacity = ctx->downtimeCapacity == 0 ? 16 : ctx->downtimeCapacity * 2;
+        Downtime* downtime = (Downtime*)realloc(ctx->downtime, sizeof(Downtime) * (size_t)newCapacity);
+        if (downtime == NULL) {
+            message(ctx, "Out of memory. Downtime not added.\n");
+            return false;
+        }
+        ctx->downtime = downtime;
+        ctx->downtimeCapacity = newCapacity;
+    }
+    Downtime* downtime = &ctx->downtime[ctx->downtimeCount++];
+    downtime->plant = plant;
+    downtime->first_day = first_day;
+    downtime->last_day = last_day;
+    ctx->setup++;
+    if (plant < 0) {
+        message(ctx, "Holiday added from %s to %s.\n", first_date, last_date);
+    } else {
+        message(ctx, "Plant %s down from %s to %s.\n", ctx->plants.name[plant], first_date, last_date);
+    }
+    return true;
+}
+
+// function to drop the plant calendar
+static void clearCalendar(pls_context* ctx) {
+    free(ctx->downtime);
+    ctx->downtime = NULL;
+    ctx->downtimeCount = ctx->downtimeCapacity = 0;
+    ctx->setup++;
+}
+
+// helper function to take a read-only view of the orders, plants and period for a scheduling run
+// (order columns are only ever appended to, and a grown column is copied, so the view stays valid)
+static Snapshot takeSnapshot(pls_context* ctx) {
+    Snapshot snapshot;
+    snapshot.orderCount = ctx->orders.count;
+    snapshot.due_day = ctx->orders.due_day;
+    snapshot.quantity = ctx->orders.quantity;
+    snapshot.product_id = ctx->orders.product_id;
+    snapshot.productCount = ctx->products.count;
+    snapshot.plantCount = ctx->plants.count;
+    snapshot.capacity = ctx->plants.capacity;
+    snapshot.downtime = ctx->downtime;
+    snapshot.downtimeCount = ctx->downtimeCount;
+    snapshot.start_day = ctx->period.start_day;
+    snapshot.numDays = ctx->numberOfDays;
+    snapshot.setup = ctx->setup;
+    snapshot.changeover = ctx->changeover;
+    snapshot.dueKeys = NULL;
+    snapshot.optBudget = ctx->optBudget;
+    snapshot.convergence = NULL;
+    snapshot.stats = activeStats(ctx);
+    return snapshot;
+}
+
+// helper function to find out whether a plant works on a day of the period, and the first later day on which that can change
+// (INT_MAX when nothing changes again; the calendar is short, so it is simply scanned)
+static bool plantWorks(const Snapshot* snapshot, int plant, int day, int* until) {
+    int next = INT_MAX;
+    bool works = true;
+    for (int i = 0; i < snapshot->downtimeCount; i++) {
+        const Downtime* downtime = &snapshot->downtime[i];
+        if (downtime->plant >= 0 && downtime->plant != plant) continue;
+        int first = downtime->first_day - snapshot->start_day;
+        if (first > day) {
+            if (first < next) next = first;
+        } else if (day <= downtime->last_day - snapshot->start_day) {
+            works = false;
+        }
+    }
+    if (!works) {
+        // stretches of downtime can overlap or touch, so the plant is down until the first day none of them covers
+        next = day;
+        for (bool covered = true; covered; ) {
+            covered = false;
+            for (int i = 0; i < snapshot->downtimeCount; i++) {
+                const Downtime* downtime = &snapshot->downtime[i];
+                if (downtime->plant >= 0 && downtime->plant != plant) continue;
+                if (downtime->first_day - snapshot->start_day <= next && next <= downtime->last_day - snapshot->start_day) {
+                    next = downtime->last_day - snapshot->start_day + 1;
+                    covered = true;
+                }
+            }
+        }
+    }
+    *until = next;
+    return works;
+}
+
+// helper function to mark the plants that work on a day and find the end of the window of days over which none of them
+// changes (at most the end of the period); the scheduling loops move from one window to the next, so what they keep
+// in memory depends on the plants and the orders, never on the length of the period
+static int workingWindow(const Snapshot* snapshot, int day, bool* works, int* working) {
+    int end = snapshot->numDays;
+    *working = 0;
+    for (int k = 0; k < snapshot->plantCount; k++) {
+        int until;
+        works[k] = plantWorks(snapshot, k, day, &until);
+        if (works[k]) (*working)++;
+        if (until < end) end = until;
+    }
+    return end;
+}
+
+// helper function to make room in a schedule for a run over the given plants and orders
+static bool prepareSchedule(Schedule* schedule, int plantCount, int orderCount) {
+    if (schedule->plantCount < plantCount) {
+        int* plantState = (int*)realloc(schedule->plantOrder, sizeof(int) * 4 * (size_t)plantCount);
+        if (plantState == NULL) return false;
+        schedule->plantOrder = plantState;
+    }
+    if (schedule->orderCapacity < orderCount) {
+        long long* dueKeys = (long long*)realloc(schedule->dueKeys, sizeof(long long) * (size_t)orderCount);
+        if (dueKeys != NULL) schedule->dueKeys = dueKeys;
+        int* sequence = (int*)realloc(schedule->sequence, sizeof(int) * (size_t)orderCount);
+        if (sequence != NULL) schedule->sequence = sequence;
+        if (dueKeys == NULL || sequence == NULL) return false;
+        schedule->orderCapacity = orderCount;
+    }
+
+    schedule->plantCount = plantCount;
+    schedule->lastSegment = schedule->plantOrder + plantCount;
+    schedule->days = schedule->lastSegment + plantCount;
+    schedule->produce = schedule->days + plantCount;
+    for (int i = 0; i < plantCount; i++) {
+        schedule->plantOrder[i] = i;
+    }
+    return true;
+}
+
+// helper function to cut a schedule back to the days before the given one, so a run can carry on from that day
+// (the run extends the segments that end there again, so the result is the same as building it in one go)
+static void truncateSchedule(Schedule* schedule, int day) {
+    for (int i = 0; i < schedule->plantCount; i++) {
+        schedule->lastSegment[i] = -1;
+        schedule->days[i] = 0;
+        schedule->produce[i] = 0;
+    }
+
+    // segments are appended in day order, so the ones starting on or after the day are at the end
+    int count = 0;
+    while (count < schedule->count && schedule->segments[count].start_day < day) {
+        Segment* segment = &schedule->segments[count];
+        if (segment->start_day + segment->run_length > day) segment->run_length = day - segment->start_day;
+        schedule->days[segment->plant] += segment->run_length;
+        schedule->produce[segment->plant] += segment->run_length * segment->units;
+        schedule->lastSegment[segment->plant] = count++;
+    }
+    schedule->count = count;
+
+    while (schedule->stepCount > 0 && schedule->steps[schedule->stepCount - 1].day >= day) schedule->stepCount--;
+    if (schedule->idleDay >= day) schedule->idleDay = INT_MAX;
+}
+
+// helper function to release the memory of a schedule
+static void freeSchedule(Schedule* schedule) {
+    free(schedule->segments);
+    free(schedule->plantOrder);
+    free(schedule->rejected);
+    free(schedule->dueKeys);
+    free(schedule->sequence);
+    free(schedule->steps);
+    memset(schedule, 0, sizeof(Schedule));
+}
+
+// helper function to record the first day of an SJF allocation and the largest quantity it picked
+static bool appendStep(Schedule* schedule, int day, int largest) {
+    if (schedule->stepCount == schedule->stepCapacity) {
+        int newCapacity = schedule->stepCapacity == 0 ? 64 : schedule->stepCapacity * 2;
+        Step* steps = (Step*)realloc(schedule->steps, sizeof(Step) * (size_t)newCapacity);
+        if (steps == NULL) return false;
+        schedule->steps = steps;
+        schedule->stepCapacity = newCapacity;
+    }
+    schedule->steps[schedule->stepCount].day = day;
+    schedule->steps[schedule->stepCount++].largest = largest;
+    return true;
+}
+
+// helper function to record that a plant spends a run of days on an order, extending the plant's previous run when it continues it
+static bool appendSegment(Schedule* schedule, int plant, int row, int start_day, int run_length, int units) {
+    schedule->days[plant] += run_length;
+    schedule->produce[plant] += run_length * units;
+
+    int last = schedule->lastSegment[plant];
+    if (last >= 0) {
+        Segment* previous = &schedule->segments[last];
+        if (previous->order == row && previous->units == units && previous->start_day + previous->run_length == start_day) {
+            previous->run_length += run_length;
+            return true;
+        }
+    }
+
+    if (schedule->count == schedule->capacity) {
+        int newCapacity = schedule->capacity == 0 ? 256 : schedule->capacity * 2;
+        Segment* segments = (Segment*)realloc(schedule->segments, sizeof(Segment) * (size_t)newCapacity);
+        if (segments == NULL) return false;
+        schedule->segments = segments;
+        schedule->capacity = newCapacity;
+    }
+
+    Segment* segment = &schedule->segments[schedule->count];
+    segment->plant = plant;
+    segment->order = row;
+    segment->start_day = start_day;
+    segment->run_length = run_length;
+    segment->units = units;
+    schedule->lastSegment[plant] = schedule->count++;
+    return true;
+}
+
+// a structure for an output buffer that is formatted by hand and written out in large blocks
+typedef struct Writer {
+    FILE* stream;
+    char* buffer;
+    size_t used, size;
+    size_t written;             // bytes handed to the stream so far
+    bool failed;
+} Writer;
+
+// helper function to start writing to a stream through an output buffer that is allocated on first use, false when out of memory
+static bool openWriter(char** buffer, Writer* writer, FILE* stream) {
+    if (*buffer == NULL) {
+        *buffer = (char*)malloc(OUTPUT_BUFFER);
+        if (*buffer == NULL) return false;
+    }
+    writer->stream = stream;
+    writer->buffer = *buffer;
+    writer->used = 0;
+    writer->size = OUTPUT_BUFFER;
+    writer->written = 0;
+    writer->failed = false;
+    return true;
+}
+
+// helper function to write out what is in the buffer, false if any write failed so far
+static bool flushWriter(Writer* writer) {
+    if (writer->used > 0 && fwrite(writer->buffer, 1, writer->used, writer->stream) != writer->used) writer->failed = true;
+    writer->written += writer->used;
+    writer->used = 0;
+    return !writer->failed;
+}
+
+// helper function to add bytes to the buffer
+static void writeBytes(Writer* writer, const char* bytes, size_t length) {
+    if (writer->size - writer->used < length) {
+        flushWriter(writer);
+        if (length > writer->size) {
+            if (fwrite(bytes, 1, length, writer->stream) != length) writer->failed = true;
+            writer->written += length;
+            return;
+        }
+    }
+    memcpy(writer->buffer + writer->used, bytes, length);
+    writer->used += length;
+}
+
+// helper function to add a string to the buffer
+static void writeText(Writer* writer, const char* text) {
+    writeBytes(writer, text, strlen(text));
+}
+
+// helper function to add a single character to the buffer
+static void writeChar(Writer* writer, char c) {
+    if (writer->used == writer->size) flushWriter(writer);
+    writer->buffer[writer->used++] = c;
+}
+
+// helper function to add an integer in decimal, formatted by hand
+static void writeInt(Writer* writer, long long value) {
+    char digits[24];
+    int length = 0;
+    unsigned long long magnitude = value < 0 ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+    do {
+        digits[sizeof(digits) - 1 - length++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (value < 0) digits[sizeof(digits) - 1 - length++] = '-';
+    writeBytes(writer, digits + sizeof(digits) - length, (size_t)length);
+}
+
+// helper function to add a number with two decimals (only used for the few percentages of a report)
+static void writeFixed(Writer* writer, double value) {
+    char text[32];
+    int length = snprintf(text, sizeof(text), "%.2f", value);
+    writeBytes(writer, text, (size_t)length);
+}
+
+// helper function to add a date given as a day number
+static void writeDate(Writer* writer, int day) {
+    char date[DATE];
+    formatDate(day, date);
+    writeBytes(writer, date, DATE - 1);
+}
+
+// helper function to add one field of a CSV or TSV row, quoting a CSV field that holds a separator or a quote
+// (fields come from whitespace-separated commands, so a TSV field never holds a tab)
+static void writeField(Writer* writer, const char* text, char separator) {
+    if (separator != ',' || strpbrk(text, ",\"") == NULL) {
+        writeText(writer, text);
+        return;
+    }
+    writeChar(writer, '"');
+    for (; *text; text++) {
+        if (*text == '"') writeChar(writer, '"');
+        writeChar(writer, *text);
+    }
+    writeChar(writer, '"');
+}
+
+// function to print the orders the admission check turned away
+static void printRejections(pls_context* ctx, const Schedule* schedule) {
+    if (ctx->messages == NULL || ctx->traceLevel < PLS_TRACE_REJECTIONS || schedule->rejectedCount == 0) return;
+
+    Writer writer;
+    if (!openWriter(&ctx->outputBuffer, &writer, ctx->messages)) {
+        message(ctx, "Out of memory. Rejections not printed.\n");
+        return;
+    }
+    for (int i = 0; i < schedule->rejectedCount; i++) {
+        int row = schedule->rejected[i];
+        writeText(&writer, "Order ");
+        writeText(&writer, ctx->orders.order_number[row]);
+        writeText(&writer, " rejected as it cannot be completed by its due date ");
+        writeDate(&writer, ctx->orders.due_day[row]);
+        writeText(&writer, ".\n");
+    }
+    flushWriter(&writer);
+    if (ctx->stats.enabled) ctx->stats.bytesWritten += (long long)writer.written;
+}
+
+// helper function to expand a schedule into the day by day allocation trace
+static void printScheduleTrace(pls_context* ctx, const Schedule* schedule, const Snapshot* snapshot) {
+    if (ctx->messages == NULL || ctx->traceLevel < PLS_TRACE_DAYS) return;
+
+    int plantCount = schedule->plantCount;
+    Writer writer;
+    int* remaining = (int*)malloc(sizeof(int) * ((size_t)ctx->orders.count + (size_t)schedule->count + 2 * (size_t)plantCount + 1));
+    if (remaining == NULL || !openWriter(&ctx->outputBuffer, &writer, ctx->messages)) {
+        free(remaining);
+        message(ctx, "Out of memory. Schedule trace not printed.\n");
+        return;
+    }
+    memcpy(remaining, ctx->orders.quantity, sizeof(int) * (size_t)ctx->orders.count);
+
+    // segments grouped by plant (each plant's runs are already in time order)
+    int* byPlant = remaining + ctx->orders.count;
+    int* plantStart = byPlant + schedule->count;
+    int* cursor = plantStart + plantCount + 1;
+    memset(plantStart, 0, sizeof(int) * ((size_t)plantCount + 1));
+    for (int i = 0; i < schedule->count; i++) plantStart[schedule->segments[i].plant + 1]++;
+    for (int i = 0; i < plantCount; i++) plantStart[i + 1] += plantStart[i];
+    memcpy(cursor, plantStart, sizeof(int) * (size_t)plantCount);
+    for (int i = 0; i < schedule->count; i++) byPlant[cursor[schedule->segments[i].plant]++] = i;
+    memcpy(cursor, plantStart, sizeof(int) * (size_t)plantCount);
+
+    for (int day = 0; day < snapshot->numDays; day++) {
+        writeText(&writer, "Day ");
+        writeInt(&writer, day + 1);
+        writeText(&writer, ":\n");
+
+        for (int k = 0; k < plantCount; k++) {
+            int i = schedule->plantOrder[k];
+            while (cursor[i] < plantStart[i + 1]) {
+                const Segment* segment = &schedule->segments[byPlant[cursor[i]]];
+                if (segment->start_day + segment->run_length > day) break;
+                cursor[i]++;
+            }
+            int until;
+            if ((cursor[i] == plantStart[i + 1] || schedule->segments[byPlant[cursor[i]]].start_day > day) &&
+                snapshot->downtimeCount > 0 && !plantWorks(snapshot, i, day, &until)) {
+                writeText(&writer, "  ");
+                writeText(&writer, ctx->plants.name[i]);
+                writeText(&writer, " is down for the day.\n");
+            }
+            if (cursor[i] == plantStart[i + 1]) continue;
+
+            const Segment* segment = &schedule->segments[byPlant[cursor[i]]];
+            if (segment->start_day > day) continue;
+
+            writeText(&writer, "  ");
+            writeText(&writer, ctx->plants.name[i]);
+            writeText(&writer, " is allocated to Order ");
+            writeText(&writer, ctx->orders.order_number[segment->order]);
+            writeText(&writer, " for the day. ");
+            writeInt(&writer, segment->units);
+            writeText(&writer, " units to be produced. Remaining before production: ");
+            writeInt(&writer, remaining[segment->order]);
+            writeChar(&writer, '\n');
+            remaining[segment->order] -= segment->units;
+        }
+        writeChar(&writer, '\n');
+    }
+
+    flushWriter(&writer);
+    if (ctx->stats.enabled) ctx->stats.bytesWritten += (long long)writer.written;
+    free(remaining);
+}
+
+// helper function to work out the utilization of the plants over the days they are in use
+static double utilization(const Schedule* schedule, const int* capacity, int plant) {
+    double totalProduce = 0, totalCapacity = 0;
+    for (int i = 0; i < schedule->plantCount; i++) {
+        if (plant >= 0 && i != plant) continue;
+        totalCapacity += (double)capacity[i] * schedule->days[i];
+        totalProduce += schedule->produce[i];
+    }
+    return totalCapacity == 0 ? 0 : totalProduce / totalCapacity;
+}
+
+// a structure for what a report is written from: the order and product columns, which only ever grow, so they can be
+// read while new orders come in, and the plants and period as they were when the report was asked for
+typedef struct ReportView {
+    const char (*order_number)[ORDER_ID];
+    const int* due_day;
+    const int* quantity;
+    const int* product_id;
+    const char (*product_name)[PRODUCT_NAME];
+    const char (*plant_name)[PLANT_NAME];
+    const int* capacity;
+    int start_day;
+    int reportFormat;
+} ReportView;
+
+// helper function to take a view of the context for a report (borrowing its plants, which a later command may change)
+static ReportView takeReportView(const pls_context* ctx) {
+    ReportView view;
+    view.order_number = (const char (*)[ORDER_ID])ctx->orders.order_number;
+    view.due_day = ctx->orders.due_day;
+    view.quantity = ctx->orders.quantity;
+    view.product_id = ctx->orders.product_id;
+    view.product_name = (const char (*)[PRODUCT_NAME])ctx->products.name;
+    view.plant_name = (const char (*)[PLANT_NAME])ctx->plants.name;
+    view.capacity = ctx->plants.capacity;
+    view.start_day = ctx->period.start_day;
+    view.reportFormat = ctx->reportFormat;
+    return view;
+}
+
+// helper function to write the report of a schedule as text
+static void writeTextReport(const ReportView* view, Writer* writer, const char* algorithm, const Schedule* schedule) {
+    writeText(writer, "***PLS Schedule Analysis Report***\n");
+    writeText(writer, "Algorithm used: ");
+    writeText(writer, algorithm);
+    writeText(writer, "\n");
+
+    writeText(writer, "There are ");
+    writeInt(writer, schedule->orderCount - schedule->rejectedCount);
+    writeText(writer, " Orders ACCEPTED. Details are as follows:\n");
+    writeText(writer, "ORDER NUMBER START END DAYS QUANTITY PLANT\n");
+    writeText(writer, "===========================================================================\n");
+
+    for (int i = 0; i < schedule->count; i++) {
+        const Segment* segment = &schedule->segments[i];
+        writeText(writer, view->order_number[segment->order]);
+        writeChar(writer, ' ');
+        writeDate(writer, view->start_day + segment->start_day);
+        writeChar(writer, ' ');
+        writeDate(writer, view->start_day + segment->start_day + segment->run_length - 1);
+        writeChar(writer, ' ');
+        writeInt(writer, segment->run_length);
+        writeChar(writer, ' ');
+        writeInt(writer, segment->run_length * segment->units);
+        writeChar(writer, ' ');
+        writeText(writer, view->plant_name[segment->plant]);
+        writeChar(writer, '\n');
+    }
+    writeText(writer, "- End -\n");
+    writeText(writer, "===========================================================================\n\n");
+
+    writeText(writer, "There are ");
+    writeInt(writer, schedule->rejectedCount);
+    writeText(writer, " Orders REJECTED. Details are as follows:\n");
+    writeText(writer, "ORDER NUMBER PRODUCT NAME Due Date QUANTITY\n");
+    writeText(writer, "===========================================================================\n");
+
+    for (int i = 0; i < schedule->rejectedCount; i++) {
+        int row = schedule->rejected[i];
+        writeText(writer, view->order_number[row]);
+        writeChar(writer, ' ');
+        writeText(writer, view->product_name[view->product_id[row]]);
+        writeChar(writer, ' ');
+        writeDate(writer, view->due_day[row]);
+        writeChar(writer, ' ');
+        writeInt(writer, view->quantity[row]);
+        writeChar(writer, '\n');
+    }
+    writeText(writer, "- End -\n");
+    writeText(writer, "===========================================================================\n\n");
+
+    writeText(writer, "***PERFORMANCE\n\n");
+
+    for (int i = 0; i < schedule->plantCount; i++) {
+        writeText(writer, view->plant_name[i]);
+        writeText(writer, ":\nNumber of days in use: ");
+        writeInt(writer, schedule->days[i]);
+        writeText(writer, " days\nNumber of products produced: ");
+        writeInt(writer, schedule->produce[i]);
+        writeText(writer, " (in total)\nUtilization of the plant: ");
+        writeFixed(writer, utilization(schedule, view->capacity, i) * 100);
+        writeText(writer, " %\n\n");
+    }
+
+    writeText(writer, "Overall utilization: ");
+    writeFixed(writer, utilization(schedule, view->capacity, -1) * 100);
+    writeText(writer, " %\n\n");
+}
+
+// helper function to write the report of a schedule as CSV or TSV: one row per record, the record type in the first
+// column and the columns that do not apply to it left empty, so a loader can read the whole report as one table
+static void writeTableReport(const ReportView* view, Writer* writer, const Schedule* schedule, char separator) {
+    const char* columns[] = {"record", "order_number", "product_name", "plant", "start_date", "end_date", "days", "quantity", "due_date", "utilization"};
+    for (int i = 0; i < 10; i++) {
+        if (i > 0) writeChar(writer, separator);
+        writeText(writer, columns[i]);
+    }
+    writeChar(writer, '\n');
+
+    for (int i = 0; i < schedule->count; i++) {
+        const Segment* segment = &schedule->segments[i];
+        int row = segment->order;
+        writeText(writer, "ACCEPTED");
+        writeChar(writer, separator);
+        writeField(writer, view->order_number[row], separator);
+        writeChar(writer, separator);
+        writeField(writer, view->product_name[view->product_id[row]], separator);
+        writeChar(writer, separator);
+        writeField(writer, view->plant_name[segment->plant], separator);
+        writeChar(writer, separator);
+        writeDate(writer, view->start_day + segment->start_day);
+        writeChar(writer, separator);
+        writeDate(writer, view->start_day + segment->start_day + segment->run_length - 1);
+        writeChar(writer, separator);
+        writeInt(writer, segment->run_length);
+        writeChar(writer, separator);
+        writeInt(writer, segment->run_length * segment->units);
+        writeChar(writer, separator);
+        writeDate(writer, view->due_day[row]);
+        writeChar(writer, separator);
+        writeChar(writer, '\n');
+    }
+
+    for (int i = 0; i < schedule->rejectedCount; i++) {
+        int row = schedule->rejected[i];
+        writeText(writer, "REJECTED");
+        writeChar(writer, separator);
+        writeField(writer, view->order_number[row], separator);
+        writeChar(writer, separator);
+        writeField(writer, view->product_name[view->product_id[row]], separator);
+        for (int k = 0; k < 5; k++) writeChar(writer, separator);
+        writeInt(writer, view->quantity[row]);
+        writeChar(writer, separator);
+        writeDate(writer, view->due_day[row]);
+        writeChar(writer, separator);
+        writeChar(writer, '\n');
+    }
+
+    for (int i = 0; i < schedule->plantCount; i++) {
+        writeText(writer, "PLANT");
+        for (int k = 0; k < 3; k++) writeChar(writer, separator);
+        writeField(writer, view->plant_name[i], separator);
+        for (int k = 0; k < 3; k++) writeChar(writer, separator);
+        writeInt(writer, schedule->days[i]);
+        writeChar(writer, separator);
+        writeInt(writer, schedule->produce[i]);
+        for (int k = 0; k < 2; k++) writeChar(writer, separator);
+        writeFixed(writer, utilization(schedule, view->capacity, i) * 100);
+        writeChar(writer, '\n');
+    }
+
+    writeText(writer, "OVERALL");
+    for (int k = 0; k < 9; k++) writeChar(writer, separator);
+    writeFixed(writer, utilization(schedule, view->capacity, -1) * 100);
+    writeChar(writer, '\n');
+}
+
+// helper function to get the seconds passed since a monotonic clock reading
+static double secondsSince(const struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// outcomes of writing a report file
+enum { REPORT_WRITTEN, REPORT_OPEN_FAILED, REPORT_NO_MEMORY, REPORT_WRITE_FAILED };
+
+// helper function to write the report of a schedule into a file in the report format of a view, through the given buffer
+static int writeReportFile(const ReportView* view, const char* algorithm, const char* fileName, const Schedule* schedule, char** buffer, long long* bytes) {
+    FILE* report_file = fopen(fileName, "w");
+    if (report_file == NULL) return REPORT_OPEN_FAILED;
+    // the writer hands over large blocks, so stdio buffering would only add a copy
+    setvbuf(report_file, NULL, _IONBF, 0);
+
+    Writer writer;
+    if (!openWriter(buffer, &writer, report_file)) {
+        fclose(report_file);
+        return REPORT_NO_MEMORY;
+    }
+    if (view->reportFormat == PLS_REPORT_TEXT) {
+        writeTextReport(view, &writer, algorithm, schedule);
+    } else {
+        writeTableReport(view, &writer, schedule, view->reportFormat == PLS_REPORT_CSV ? ',' : '\t');
+    }
+
+    bool ok = flushWriter(&writer);
+    ok = fclose(report_file) == 0 && ok;
+    *bytes = (long long)writer.written;
+    return ok ? REPORT_WRITTEN : REPORT_WRITE_FAILED;
+}
+
+// helper function to print the outcome of writing a report file
+static bool reportOutcome(pls_context* ctx, int status, const char* fileName) {
+    switch (status) {
+        case REPORT_OPEN_FAILED:
+            message(ctx, "Error opening report file %s.\n", fileName);
+            return false;
+        case REPORT_NO_MEMORY:
+            message(ctx, "Out of memory. Report %s not generated.\n", fileName);
+            return false;
+        case REPORT_WRITE_FAILED:
+            message(ctx, "Error writing report file %s.\n", fileName);
+            return false;
+        default:
+            message(ctx, "Report generated successfully.\n");
+            return true;
+    }
+}
+
+// function to print the report into a file in the report format of the context
+static bool printReport(pls_context* ctx, const char* algorithm, const char* fileName, const Schedule* schedule) {
+    Stats* stats = activeStats(ctx);
+    struct timespec start;
+    statsStart(stats, &start);
+
+    ReportView view = takeReportView(ctx);
+    long long bytes = 0;
+    int status = writeReportFile(&view, algorithm, fileName, schedule, &ctx->outputBuffer, &bytes);
+    if (stats != NULL) stats->bytesWritten += bytes;
+    statsStop(stats, PHASE_REPORT, &start);
+    return reportOutcome(ctx, status, fileName);
+}
+
+// a structure for a report handed to the background writer, with its own copy of everything a later command could change
+typedef struct ReportJob {
+    ReportView view;            // order columns of the context, plants of the job
+    char algorithm[8];
+    char* fileName;
+    char (*plant_name)[PLANT_NAME];
+    int* capacity;
+    Schedule schedule;          // segments, rejected rows and plant figures of the schedule as it was
+    int status;
+    double seconds;
+    long long bytes;
+    struct ReportJob* next;
+} ReportJob;
+
+// helper function to release a report job
+static void freeReportJob(ReportJob* job) {
+    free(job->fileName);
+    free(job->plant_name);
+    free(job->capacity);
+    freeSchedule(&job->schedule);
+    free(job);
+}
+
+// helper function to copy the last schedule and the plants of a context into a new report job, NULL when out of memory
+static ReportJob* newReportJob(pls_context* ctx, const char* algorithm, const char* fileName, const Schedule* schedule) {
+    ReportJob* job = (ReportJob*)calloc(1, sizeof(ReportJob));
+    if (job == NULL) return NULL;
+
+    int plantCount = schedule->plantCount;
+    Schedule* copy = &job->schedule;
+    job->fileName = strdup(fileName);
+    job->plant_name = malloc((size_t)ctx->plants.count * PLANT_NAME + 1);
+    job->capacity = (int*)malloc(sizeof(int) * ((size_t)ctx->plants.count + 1));
+    copy->segments = (Segment*)malloc(sizeof(Segment) * ((size_t)schedule->count + 1));
+    copy->rejected = (int*)malloc(sizeof(int) * ((size_t)schedule->rejectedCount + 1));
+    copy->plantOrder = (int*)malloc(sizeof(int) * (4 * (size_t)plantCount + 1));
+    if (job->fileName == NULL || job->plant_name == NULL || job->capacity == NULL || copy->segments == NULL ||
+        copy->rejected == NULL || copy->plantOrder == NULL) {
+        freeReportJob(job);
+        return NULL;
+    }
+
+    memcpy(job->plant_name, ctx->plants.name, (size_t)ctx->plants.count * PLANT_NAME);
+    memcpy(job->capacity, ctx->plants.capacity, sizeof(int) * (size_t)ctx->plants.count);
+    memcpy(copy->segments, schedule->segments, sizeof(Segment) * (size_t)schedule->count);
+    memcpy(copy->rejected, schedule->rejected, sizeof(int) * (size_t)schedule->rejectedCount);
+    memcpy(copy->plantOrder, schedule->plantOrder, sizeof(int) * 4 * (size_t)plantCount);
+    copy->count = copy->capacity = schedule->count;
+    copy->rejectedCount = copy->rejectedCapacity = schedule->rejectedCount;
+    copy->plantCount = plantCount;
+    copy->lastSegment = copy->plantOrder + plantCount;
+    copy->days = copy->lastSegment + plantCount;
+    copy->produce = copy->days + plantCount;
+    copy->orderCount = schedule->orderCount;
+
+    job->view = takeReportView(ctx);
+    job->view.plant_name = (const char (*)[PLANT_NAME])job->plant_name;
+    job->view.capacity = job->capacity;
+    snprintf(job->algorithm, sizeof(job->algorithm), "%s", algorithm);
+    return job;
+}
+
+// function for the background writer thread: writes the queued reports one at a time, oldest first
+static void* runReportWriter(void* argument) {
+    pls_context* ctx = (pls_context*)argument;
+    pthread_mutex_lock(&ctx->reportLock);
+    while (1) {
+        while (ctx->reportQueue == NULL && !ctx->reportStop) {
+            pthread_cond_wait(&ctx->reportChanged, &ctx->reportLock);
+        }
+        ReportJob* job = ctx->reportQueue;
+        if (job == NULL) break;
+        pthread_mutex_unlock(&ctx->reportLock);
+
+        struct timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        job->status = writeReportFile(&job->view, job->algorithm, job->fileName, &job->schedule, &ctx->reportBuffer, &job->bytes);
+        job->seconds = secondsSince(&start);
+
+        // the job moves from the queue to the end of the finished list
+        pthread_mutex_lock(&ctx->reportLock);
+        ctx->reportQueue = job->next;
+        job->next = NULL;
+        ReportJob** last = &ctx->reportsDone;
+        while (*last != NULL) last = &(*last)->next;
+        *last = job;
+        ctx->reportsPending--;
+        pthread_cond_broadcast(&ctx->reportChanged);
+    }
+    pthread_mutex_unlock(&ctx->reportLock);
+    return NULL;
+}
+
+// helper function to print the outcome of the reports the writer has finished since the last call, returns how many failed
+static int reapReports(pls_context* ctx) {
+    pthread_mutex_lock(&ctx->reportLock);
+    ReportJob* job = ctx->reportsDone;
+    ctx->reportsDone = NULL;
+    pthread_mutex_unlock(&ctx->reportLock);
+
+    int failed = 0;
+    while (job != NULL) {
+        ReportJob* next = job->next;
+        if (job->status == REPORT_WRITTEN) {
+            message(ctx, "Report %s generated successfully.\n", job->fileName);
+        } else if (!reportOutcome(ctx, job->status, job->fileName)) {
+            failed++;
+        }
+        Stats* stats = activeStats(ctx);
+        if (stats != NULL) {
+            stats->bytesWritten += job->bytes;
+            statsRecord(stats, PHASE_REPORT, (long long)(job->seconds * 1e9));
+        }
+        freeReportJob(job);
+        job = next;
+    }
+    return failed;
+}
+
+// function to wait until the writer has finished every queued report, false if any of them failed
+static bool waitReports(pls_context* ctx) {
+    pthread_mutex_lock(&ctx->reportLock);
+    while (ctx->reportsPending > 0) {
+        pthread_cond_wait(&ctx->reportChanged, &ctx->reportLock);
+    }
+    pthread_mutex_unlock(&ctx->reportLock);
+    return reapReports(ctx) == 0;
+}
+
+// function to hand the report of a schedule to the background writer, starting the writer on first use
+// (if the writer cannot be started or the copy does not fit in memory, the report is written straight away)
+static bool queueReport(pls_context* ctx, const char* algorithm, const char* fileName, const Schedule* schedule) {
+    reapReports(ctx);
+    if (!ctx->reportThreadStarted) {
+        ctx->reportThreadStarted = pthread_create(&ctx->reportThread, NULL, runReportWriter, ctx) == 0;
+        if (!ctx->reportThreadStarted) return printReport(ctx, algorithm, fileName, schedule);
+    }
+    ReportJob* job = newReportJob(ctx, algorithm, fileName, schedule);
+    if (job == NULL) return printReport(ctx, algorithm, fileName, schedule);
+
+    pthread_mutex_lock(&ctx->reportLock);
+    ReportJob** last = &ctx->reportQueue;
+    while (*last != NULL) last = &(*last)->next;
+    *last = job;
+    ctx->reportsPending++;
+    pthread_cond_broadcast(&ctx->reportChanged);
+    pthread_mutex_unlock(&ctx->reportLock);
+    message(ctx, "Report %s queued.\n", fileName);
+    return true;
+}
+
+// function to stop the background writer once it has written every queued report
+static void stopReportWriter(pls_context* ctx) {
+    if (!ctx->reportThreadStarted) return;
+
+    waitReports(ctx);
+    pthread_mutex_lock(&ctx->reportLock);
+    ctx->reportStop = true;
+    pthread_cond_broadcast(&ctx->reportChanged);
+    pthread_mutex_unlock(&ctx->reportLock);
+    pthread_join(ctx->reportThread, NULL);
+    ctx->reportThreadStarted = false;
+    ctx->reportStop = false;
+}
+
+// helper function to order two heap entries by remaining quantity, breaking ties by arrival
+static bool heapBefore(const int* quantities, int a, int b) {
+    return quantities[a] < quantities[b] || (quantities[a] == quantities[b] && a < b);
+}
+
+// helper function to move a heap entry up until its parent is smaller
+static void heapSiftUp(int* heap, int position, const int* quantities) {
+    int entry = heap[position];
+    while (position > 0) {
+        int parent = (position - 1) / 2;
+        if (!heapBefore(quantities, entry, heap[parent])) break;
+        heap[position] = heap[parent];
+        position = parent;
+    }
+    heap[position] = entry;
+}
+
+// helper function to move a heap entry down until both children are larger
+static void heapSiftDown(int* heap, int size, int position, const int* quantities) {
+    int entry = heap[position];
+    while (1) {
+        int child = 2 * position + 1;
+        if (child >= size) break;
+        if (child + 1 < size && heapBefore(quantities, heap[child + 1], heap[child])) child++;
+        if (!heapBefore(quantities, heap[child], entry)) break;
+        heap[position] = heap[child];
+        position = child;
+    }
+    heap[position] = entry;
+}
+
+
+// helper function to add a row to the rejected list of a schedule, growing the list as needed
+static bool appendRejected(Schedule* schedule, int row) {
+    if (schedule->rejectedCount == schedule->rejectedCapacity) {
+        int newCapacity = schedule->rejectedCapacity == 0 ? 64 : schedule->rejectedCapacity * 2;
+        int* rejected = (int*)realloc(schedule->rejected, sizeof(int) * (size_t)newCapacity);
+        if (rejected == NULL) return false;
+        schedule->rejected = rejected;
+        schedule->rejectedCapacity = newCapacity;
+    }
+    schedule->rejected[schedule->rejectedCount++] = row;
+    return true;
+}
+
+// helper function to build the sort key of a row from a value such as its due day: the value times 2^32 plus the row,
+// so the keys sort by value and then by row and the row is the low 32 bits (a multiply, since shifting a negative value is undefined)
+static long long sortKey(int value, int row) {
+    return (long long)value * 4294967296LL + (long long)(uint32_t)row;
+}
+
+// helper function to compare two (due day, row) keys
+static int compareDueKeys(const void* a, const void* b) {
+    long long x = *(const long long*)a, y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+
+// helper function to get the units all plants together can produce from one day of the period up to another,
+// one calendar window at a time (plants are assumed to keep going after the period ends)
+static long long capacityBetween(const Snapshot* snapshot, int from, int to) {
+    long long units = 0;
+    while (from < to) {
+        int next = to;
+        long long daily = 0;
+        for (int k = 0; k < snapshot->plantCount; k++) {
+            int until;
+            if (plantWorks(snapshot, k, from, &until)) daily += snapshot->capacity[k];
+            if (until < next) next = until;
+        }
+        units += daily * (next - from);
+        from = next;
+    }
+    return units;
+}
+
+// helper function to split the orders into the accepted rows and the rejected list of the schedule
+// orders are admitted in due order while the accepted units due by each due day fit in the capacity of all plants
+// up to that day; an order that would break this is rejected, so earlier commitments are never given up
+// the sorted keys are kept in the schedule, so when it is extended only the new orders are sorted and merged in
+// returns a scratch block of 3 * orderCount ints whose first part holds the accepted rows (in due order if asked, else in arrival order)
+static int* admitOrders(const Snapshot* snapshot, Schedule* schedule, bool extend, bool dueOrder, int* acceptedCount) {
+    struct timespec start;
+    statsStart(snapshot->stats, &start);
+    int orderCount = snapshot->orderCount;
+    int from = extend ? schedule->orderCount : 0;
+    int* rows = (int*)malloc(sizeof(int) * (3 * (size_t)orderCount + 1));
+    long long* added = (long long*)malloc(sizeof(long long) * ((size_t)(orderCount - from) + 1));
+    if (rows == NULL || added == NULL) {
+        free(rows);
+        free(added);
+        return NULL;
+    }
+
+    // sort the keys of the new orders and merge them into the sorted keys of the earlier ones, from the back
+    // (runs sharing a snapshot with sorted keys just copy them)
+    long long* keys = schedule->dueKeys;
+    if (snapshot->dueKeys != NULL && from == 0) {
+        memcpy(keys, snapshot->dueKeys, sizeof(long long) * (size_t)orderCount);
+    } else {
+        for (int row = from; row < orderCount; row++) {
+            added[row - from] = sortKey(snapshot->due_day[row], row);
+        }
+        qsort(added, (size_t)(orderCount - from), sizeof(long long), compareDueKeys);
+        int i = from - 1, j = orderCount - from - 1;
+        for (int k = orderCount - 1; j >= 0; k--) {
+            keys[k] = (i >= 0 && keys[i] > added[j]) ? keys[i--] : added[j--];
+        }
+    }
+    free(added);
+
+    // admitted flags, in the part of the scratch block the caller only uses after admission
+    // (the keys come in due order, so the capacity up to each due day is added up as the days are reached)
+    int* admitted = rows + orderCount;
+    long long demand = 0, capacity = 0;
+    int reached = 0;
+    for (int k = 0; k < orderCount; k++) {
+        int row = (int)(keys[k] & 0xffffffff);
+        int days = snapshot->due_day[row] - snapshot->start_day;
+        if (days > reached) {
+            capacity += capacityBetween(snapshot, reached, days);
+            reached = days;
+        }
+        admitted[row] = demand + snapshot->quantity[row] <= capacity;
+        if (admitted[row]) demand += snapshot->quantity[row];
+    }
+
+    schedule->orderCount = orderCount;
+    schedule->rejectedCount = 0;
+    int count = 0;
+    for (int row = 0; row < orderCount; row++) {
+        if (!admitted[row]) {
+            if (!appendRejected(schedule, row)) {
+                free(rows);
+                return NULL;
+            }
+        } else if (!dueOrder) {
+            rows[count++] = row;
+        }
+    }
+    for (int k = 0; k < orderCount && dueOrder; k++) {
+        int row = (int)(keys[k] & 0xffffffff);
+        if (admitted[row]) rows[count++] = row;
+    }
+    *acceptedCount = count;
+
+    if (snapshot->stats != NULL) {
+        snapshot->stats->ordersScanned += orderCount;
+        snapshot->stats->ordersAdmitted += count;
+        statsStop(snapshot->stats, PHASE_ADMISSION, &start);
+    }
+    return rows;
+}
+
+// helper function to work out the quantities of the given rows still to be produced after the days kept in a schedule
+static bool remainingAfter(const Snapshot* snapshot, const Schedule* schedule, const int* rows, int orderCount, int* remaining) {
+    int* produced = (int*)calloc((size_t)snapshot->orderCount + 1, sizeof(int));
+    if (produced == NULL) return false;
+
+    for (int s = 0; s < schedule->count; s++) {
+        const Segment* segment = &schedule->segments[s];
+        produced[segment->order] += segment->run_length * segment->units;
+    }
+    for (int i = 0; i < orderCount; i++) {
+        remaining[i] = snapshot->quantity[rows[i]] - produced[rows[i]];
+    }
+    free(produced);
+    return true;
+}
+
+// helper function to find the day a sequence schedule has to be redone from for a new sequence of rows
+// days before the first allocation that reaches a position where the sequences differ, or that leaves a plant free,
+// come out the same, so only the days from there on are recomputed (0 when the schedule cannot be extended)
+static int sequenceResumeDay(const Snapshot* snapshot, const Schedule* schedule, const int* rows, int orderCount, bool extend) {
+    if (!extend) return 0;
+
+    const int* previous = schedule->sequence;
+    int previousCount = schedule->sequenceCount;
+    int same = 0;
+    while (same < previousCount && same < orderCount && previous[same] == rows[same]) same++;
+    if (same == previousCount && same == orderCount) return snapshot->numDays;
+    if (same == 0) return 0;
+
+    char* moved = (char*)calloc((size_t)snapshot->orderCount + 1, 1);
+    if (moved == NULL) return 0;
+    for (int i = same; i < previousCount; i++) {
+        moved[previous[i]] = 1;
+    }
+
+    // segments are appended in day order, so the first one on a moved row starts the earliest
+    int day = schedule->idleDay;
+    for (int s = 0; s < schedule->count && schedule->segments[s].start_day < day; s++) {
+        if (moved[schedule->segments[s].order]) day = schedule->segments[s].start_day;
+    }
+    free(moved);
+    return day < snapshot->numDays ? day : snapshot->numDays;
+}
+
+// helper function to find the day an SJF schedule has to be redone from for a new list of rows
+// when the earlier rows are unchanged, new orders only come in on the first allocation that picked a quantity larger
+// than the smallest new one, or that left a plant free; anything else is redone from the start
+static int shortestResumeDay(const Snapshot* snapshot, const Schedule* schedule, const int* rows, int orderCount, bool extend) {
+    if (!extend) return 0;
+
+    int previousCount = schedule->sequenceCount;
+    if (orderCount < previousCount || memcmp(rows, schedule->sequence, sizeof(int) * (size_t)previousCount) != 0) return 0;
+
+    int smallest = INT_MAX;
+    for (int i = previousCount; i < orderCount; i++) {
+        int quantity = snapshot->quantity[rows[i]];
+        if (quantity > 0 && quantity < smallest) smallest = quantity;
+    }
+    if (smallest == INT_MAX) return snapshot->numDays;
+
+    int day = schedule->idleDay;
+    for (int s = 0; s < schedule->stepCount && schedule->steps[s].day < day; s++) {
+        if (schedule->steps[s].largest > smallest) day = schedule->steps[s].day;
+    }
+    return day < snapshot->numDays ? day : snapshot->numDays;
+}
+
+// helper function to add the figures of a scheduling loop to the statistics
+static void countAllocations(Stats* stats, int resumeDay, long long allocations, long long rounds, long long daysCovered) {
+    if (stats == NULL) return;
+
+    if (resumeDay > 0) {
+        stats->runsExtended++;
+        stats->daysReused += resumeDay;
+    }
+    stats->allocations += allocations;
+    stats->rounds += rounds;
+    stats->daysCovered += daysCovered;
+}
+
+// helper function to work out how many days in a row a day's allocation can be repeated
+// the allocation is applied once already; it repeats while every plant produces a full day and none of its orders run out
+// (the plants working on the same order are next to each other in the allocation)
+static int repeatableDays(const Snapshot* snapshot, int* remaining, const int* touched, const int* plantOf, const int* units, int used, int daysLeft) {
+    int extra = daysLeft - 1;
+    for (int u = 0; u < used && extra > 0; ) {
+        int perDay = 0;
+        int v = u;
+        for (; v < used && touched[v] == touched[u]; v++) {
+            if (units[v] < snapshot->capacity[plantOf[v]]) return 1;
+            perDay += units[v];
+        }
+        if (remaining[touched[u]] / perDay < extra) extra = remaining[touched[u]] / perDay;
+        u = v;
+    }
+    for (int u = 0; u < used; u++) {
+        remaining[touched[u]] -= extra * units[u];
+    }
+    return extra + 1;
+}
+
+// helper function to assign orders to plants using SJF
+// each day the shortest remaining orders go to the plants in decreasing order of capacity, which is
+// the same pairing as repeatedly taking the smallest quantity/capacity ratio, but costs O(log n) per pick;
+// the orders on the plants only get shorter, so the pairing holds until one of them runs out or ends a partial day
+static bool assignOrdersToPlantsSJF(const Snapshot* snapshot, Schedule* schedule, bool extend) {
+    int plantCount = snapshot->plantCount;
+    if (!prepareSchedule(schedule, plantCount, snapshot->orderCount)) return false;
+
+    int orderCount;
+    int* rows = admitOrders(snapshot, schedule, extend, false, &orderCount);
+    int* picked = (int*)malloc(sizeof(int) * 4 * (size_t)plantCount);
+    bool* works = (bool*)malloc(sizeof(bool) * (size_t)plantCount + 1);
+    if (rows == NULL || picked == NULL || works == NULL) {
+        free(rows);
+        free(picked);
+        free(works);
+        return false;
+    }
+    int* units = picked + plantCount;
+    int* ranked = units + plantCount;
+    int* plantOf = ranked + plantCount;
+    int* plantRank = schedule->plantOrder;
+
+    int day = shortestResumeDay(snapshot, schedule, rows, orderCount, extend);
+    truncateSchedule(schedule, day);
+    int resumeDay = day;
+    long long allocations = 0, rounds = 0;
+
+    int* quantities = rows + snapshot->orderCount;
+    int* heap = quantities + snapshot->orderCount;
+    int heapSize = 0;
+    bool ok = remainingAfter(snapshot, schedule, rows, orderCount, quantities);
+    for (int i = 0; i < orderCount && ok; i++) {
+        if (quantities[i] > 0) {
+            heap[heapSize++] = i;
+        }
+    }
+    for (int i = heapSize / 2 - 1; i >= 0; i--) {
+        heapSiftDown(heap, heapSize, i, quantities);
+    }
+
+    // plants ranked by capacity, largest first (ties keep the plant order): the fastest free plant
+    // for each order of the day is simply the next one in this ranking
+    memcpy(ranked, snapshot->capacity, sizeof(int) * (size_t)plantCount);
+    for (int i = 0; i < plantCount; i++) {
+        plantRank[i] = argmaxInt(ranked, plantCount);
+        ranked[plantRank[i]] = -1;
+    }
+
+    int numDays = snapshot->numDays;
+    int windowEnd = day, working = 0;
+    while (day < numDays && heapSize > 0 && ok) {
+        if (day >= windowEnd) windowEnd = workingWindow(snapshot, day, works, &working);
+        if (working == 0) {
+            day = windowEnd;    // every plant is down until the window ends
+            continue;
+        }
+        int pickedCount = 0;
+        int largest = 0;
+
+        for (int rank = 0; rank < plantCount && heapSize > 0; rank++) {
+            int minPlant = plantRank[rank];
+            if (!works[minPlant]) continue;
+            int minOrder = heap[0];
+            heap[0] = heap[--heapSize];
+            if (heapSize > 0) heapSiftDown(heap, heapSize, 0, quantities);
+
+            int dailyProduction = snapshot->capacity[minPlant];
+            int production = (quantities[minOrder] < dailyProduction) ? quantities[minOrder] : dailyProduction;
+
+            largest = quantities[minOrder];
+            quantities[minOrder] -= production;
+            plantOf[pickedCount] = minPlant;
+            units[pickedCount] = production;
+            picked[pickedCount++] = minOrder;
+        }
+        if (pickedCount < working && day < schedule->idleDay) schedule->idleDay = day;
+        ok = appendStep(schedule, day, largest);
+
+        int length = repeatableDays(snapshot, quantities, picked, plantOf, units, pickedCount, windowEnd - day);
+        for (int i = 0; i < pickedCount; i++) {
+            ok = ok && appendSegment(schedule, plantOf[i], rows[picked[i]], day, length, units[i]);
+        }
+        day += length;
+        allocations += pickedCount;
+        rounds++;
+
+        for (int i = 0; i < pickedCount; i++) {
+            if (quantities[picked[i]] > 0) {
+                heap[heapSize] = picked[i];
+                heapSiftUp(heap, heapSize++, quantities);
+            }
+        }
+    }
+    if (day < numDays && heapSize == 0 && day < schedule->idleDay) schedule->idleDay = day;
+    countAllocations(snapshot->stats, resumeDay, allocations, rounds, day - resumeDay);
+
+    memcpy(schedule->sequence, rows, sizeof(int) * (size_t)orderCount);
+    schedule->sequenceCount = orderCount;
+    free(picked);
+    free(works);
+    free(rows);
+    return ok;
+}
+
+// helper function to give the working plants, in plant order, to the orders in the given sequence from a given day on
+// orders only ever run out in sequence order, so the first unfinished order is tracked with a cursor,
+// and the plants stay on the same orders until one of them runs out, ends a partial day or the calendar window ends
+static bool assignInSequence(const Snapshot* snapshot, Schedule* schedule, const int* rows, int orderCount, int* remaining, int day) {
+    int plantCount = snapshot->plantCount;
+    int* touched = (int*)malloc(sizeof(int) * 3 * (size_t)plantCount);
+    bool* works = (bool*)malloc(sizeof(bool) * (size_t)plantCount + 1);
+    if (touched == NULL || works == NULL) {
+        free(touched);
+        free(works);
+        return false;
+    }
+    int* plantOf = touched + plantCount;
+    int* units = plantOf + plantCount;
+
+    int numDays = snapshot->numDays;
+    int first = 0;
+    int resumeDay = day;
+    int windowEnd = day, working = 0;
+    long long allocations = 0, rounds = 0;
+    bool ok = true;
+
+    while (day < numDays && ok) {
+        if (day >= windowEnd) windowEnd = workingWindow(snapshot, day, works, &working);
+        int used = 0;
+
+        for (int i = 0; i < plantCount; i++) {
+            if (!works[i]) continue;
+            while (first < orderCount && remaining[first] <= 0) first++;
+            if (first == orderCount) break;
+
+            int dailyProduction = snapshot->capacity[i];
+            int production = (remaining[first] < dailyProduction) ? remaining[first] : dailyProduction;
+
+            remaining[first] -= production;
+            touched[used] = first;
+            plantOf[used] = i;
+            units[used++] = production;
+        }
+        if (used < working && day < schedule->idleDay) schedule->idleDay = day;
+        if (used == 0) {
+            if (working > 0) break;
+            day = windowEnd;    // every plant is down until the window ends
+            continue;
+        }
+
+        int length = repeatableDays(snapshot, remaining, touched, plantOf, units, used, windowEnd - day);
+        for (int u = 0; u < used; u++) {
+            ok = ok && appendSegment(schedule, plantOf[u], rows[touched[u]], day, length, units[u]);
+        }
+        day += length;
+        allocations += used;
+        rounds++;
+    }
+    countAllocations(snapshot->stats, resumeDay, allocations, rounds, (day < numDays ? day : numDays) - resumeDay);
+
+    free(touched);
+    free(works);
+    return ok;
+}
+
+// helper function to bring a sequence schedule up to date with a new sequence of rows, redoing only the days from where it changed
+static bool continueSequence(const Snapshot* snapshot, Schedule* schedule, int* rows, int orderCount, bool extend) {
+    int day = sequenceResumeDay(snapshot, schedule, rows, orderCount, extend);
+    truncateSchedule(schedule, day);
+
+    int* remaining = rows + snapshot->orderCount;
+    bool ok = remainingAfter(snapshot, schedule, rows, orderCount, remaining) &&
+              assignInSequence(snapshot, schedule, rows, orderCount, remaining, day);
+
+    memcpy(schedule->sequence, rows, sizeof(int) * (size_t)orderCount);
+    schedule->sequenceCount = orderCount;
+    return ok;
+}
+
+// helper function to assign orders to plants using FCFS
+static bool assignOrdersToPlantsFCFS(const Snapshot* snapshot, Schedule* schedule, bool extend) {
+    if (!prepareSchedule(schedule, snapshot->plantCount, snapshot->orderCount)) return false;
+
+    int orderCount;
+    int* rows = admitOrders(snapshot, schedule, extend, false, &orderCount);
+    if (rows == NULL) return false;
+
+    bool ok = continueSequence(snapshot, schedule, rows, orderCount, extend);
+    free(rows);
+    return ok;
+}
+
+// helper function to assign orders to plants using EDF (earliest due date first, ties in arrival order)
+static bool assignOrdersToPlantsEDF(const Snapshot* snapshot, Schedule* schedule, bool extend) {
+    if (!prepareSchedule(schedule, snapshot->plantCount, snapshot->orderCount)) return false;
+
+    int orderCount;
+    int* rows = admitOrders(snapshot, schedule, extend, true, &orderCount);
+    if (rows == NULL) return false;
+
+    bool ok = continueSequence(snapshot, schedule, rows, orderCount, extend);
+    free(rows);
+    return ok;
+}
+
+// helper function to assign orders to plants grouped by product, so that each plant works through whole products in a row
+// the accepted rows (in due order) are bucketed by product in two counting passes, the products taking their turn by
+// their earliest due date; whenever a plant comes free it goes on with its product, or takes the next one, spending
+// the changeover days first when it switches from another product; once every product has been taken, a free plant
+// takes the later half of the orders left on the busiest plant instead of standing idle
+// an order is produced one calendar window at a time, so a plant that goes down picks it up again when it is back
+static bool assignOrdersToPlantsGROUP(const Snapshot* snapshot, Schedule* schedule, bool extend) {
+    (void)extend;   // a new order can move whole product runs, so the schedule is always rebuilt
+    int plantCount = snapshot->plantCount;
+    if (!prepareSchedule(schedule, plantCount, snapshot->orderCount)) return false;
+    truncateSchedule(schedule, 0);
+    schedule->sequenceCount = 0;
+
+    int orderCount;
+    int* rows = admitOrders(snapshot, schedule, false, true, &orderCount);
+    int* groupOf = (int*)malloc(sizeof(int) * (2 * (size_t)snapshot->productCount + 2));
+    int* freeDay = (int*)malloc(sizeof(int) * 5 * (size_t)plantCount);
+    if (rows == NULL || groupOf == NULL || freeDay == NULL) {
+        free(rows);
+        free(groupOf);
+        free(freeDay);
+        return false;
+    }
+    int* groupStart = groupOf + snapshot->productCount;
+    int* product = freeDay + plantCount;
+    int* next = product + plantCount;
+    int* end = next + plantCount;
+    int* left = end + plantCount;   // units still to make of the order a plant is on, 0 when it needs a new one
+
+    // first pass: number the products in order of their earliest due order and count the orders of each
+    int groups = 0;
+    for (int p = 0; p < snapshot->productCount; p++) groupOf[p] = -1;
+    memset(groupStart, 0, sizeof(int) * ((size_t)snapshot->productCount + 2));
+    for (int i = 0; i < orderCount; i++) {
+        int p = snapshot->product_id[rows[i]];
+        if (groupOf[p] < 0) groupOf[p] = groups++;
+        groupStart[groupOf[p] + 1]++;
+    }
+    for (int g = 0; g < groups; g++) groupStart[g + 1] += groupStart[g];
+
+    // second pass: scatter the rows into their buckets, which keeps them in due order within a product
+    int* grouped = rows + snapshot->orderCount;
+    int* cursor = grouped + snapshot->orderCount;
+    memcpy(cursor, groupStart, sizeof(int) * (size_t)groups);
+    for (int i = 0; i < orderCount; i++) {
+        grouped[cursor[groupOf[snapshot->product_id[rows[i]]]]++] = rows[i];
+    }
+
+    for (int k = 0; k < plantCount; k++) {
+        freeDay[k] = 0;
+        product[k] = -1;
+        next[k] = end[k] = left[k] = 0;
+    }
+
+    // the plant that comes free first always moves next, so segments are appended in day order
+    int numDays = snapshot->numDays;
+    int nextGroup = 0;
+    long long allocations = 0, daysCovered = 0;
+    bool ok = true;
+    while (ok) {
+        int k = argminInt(freeDay, plantCount);
+        int day = freeDay[k];
+        if (day >= numDays) break;
+
+        if (left[k] == 0 && next[k] == end[k]) {
+            int from, to;
+            if (nextGroup < groups) {
+                from = groupStart[nextGroup];
+                to = groupStart[nextGroup + 1];
+                nextGroup++;
+            } else {
+                int busiest = -1;
+                for (int v = 0; v < plantCount; v++) {
+                    if (end[v] - next[v] >= 2 && (busiest < 0 || end[v] - next[v] > end[busiest] - next[busiest])) busiest = v;
+                }
+                if (busiest < 0) {
+                    if (day < schedule->idleDay) schedule->idleDay = day;
+                    freeDay[k] = INT_MAX;
+                    continue;
+                }
+                from = next[busiest] + (end[busiest] - next[busiest]) / 2;
+                to = end[busiest];
+                end[busiest] = from;
+            }
+
+            int p = snapshot->product_id[grouped[from]];
+            if (product[k] >= 0 && product[k] != p) freeDay[k] += snapshot->changeover;
+            product[k] = p;
+            next[k] = from;
+            end[k] = to;
+            continue;
+        }
+
+        if (left[k] == 0) {
+            left[k] = snapshot->quantity[grouped[next[k]++]];
+            allocations++;
+            if (left[k] <= 0) {
+                left[k] = 0;
+                continue;
+            }
+        }
+
+        int until;
+        if (!plantWorks(snapshot, k, day, &until)) {
+            freeDay[k] = until < numDays ? until : numDays;
+            continue;
+        }
+        if (until > numDays) until = numDays;
+        int row = grouped[next[k] - 1];
+        int capacity = snapshot->capacity[k];
+        int fullDays = left[k] / capacity;
+        if (fullDays > until - day) fullDays = until - day;
+        if (fullDays > 0) {
+            ok = appendSegment(schedule, k, row, day, fullDays, capacity);
+            left[k] -= fullDays * capacity;
+            day += fullDays;
+        } else {
+            ok = appendSegment(schedule, k, row, day, 1, left[k]);
+            left[k] = 0;
+            day++;
+        }
+        daysCovered += day - freeDay[k];
+        freeDay[k] = day;
+    }
+    countAllocations(snapshot->stats, 0, allocations, allocations, daysCovered);
+
+    free(groupOf);
+    free(freeDay);
+    free(rows);
+    return ok;
+}
+
+// a structure for the figures an OPT run ranks schedules by: units made by their due date first,
+// then units made within the period, then fewer plant days for them
+typedef struct Score {
+    long long onTime, produced;
+    int plantDays;
+} Score;
+
+// a structure for everything the threads of an OPT run share
+typedef struct Search {
+    Snapshot snapshot;          // with no statistics, so the threads never write to it
+    const int* starts[3];       // starting sequences: the best one first
+    int orderCount;             // accepted rows in every sequence
+    struct timespec start;
+    double budget;              // seconds
+    pthread_mutex_t lock;       // guards the best sequence, its score and the convergence
+    Score best;
+    int* bestRows;
+    Convergence* convergence;
+} Search;
+
+// a structure for a search thread of an OPT run
+typedef struct SearchWorker {
+    Search* search;
+    int id;
+    bool ok;
+} SearchWorker;
+
+// helper function to work out the score of a schedule
+static Score scoreSchedule(const Snapshot* snapshot, const Schedule* schedule) {
+    Score score = {0, 0, 0};
+    for (int i = 0; i < schedule->count; i++) {
+        const Segment* segment = &schedule->segments[i];
+        int due = snapshot->due_day[segment->order] - snapshot->start_day;
+        int onTimeDays = due - segment->start_day + 1;     // the due day itself still counts
+        if (onTimeDays > segment->run_length) onTimeDays = segment->run_length;
+        if (onTimeDays > 0) score.onTime += (long long)onTimeDays * segment->units;
+        score.produced += (long long)segment->run_length * segment->units;
+    }
+    for (int k = 0; k < schedule->plantCount; k++) score.plantDays += schedule->days[k];
+    return score;
+}
+
+// helper function to compare two scores, positive when the first is better
+static int compareScores(const Score* a, const Score* b) {
+    if (a->onTime != b->onTime) return a->onTime > b->onTime ? 1 : -1;
+    if (a->produced != b->produced) return a->produced > b->produced ? 1 : -1;
+    return (a->plantDays < b->plantDays) - (a->plantDays > b->plantDays);
+}
+
+// helper function to add an improvement to the convergence of an OPT run
+static void addConvergence(Convergence* convergence, double seconds, const Score* score, int worker) {
+    if (convergence == NULL) return;
+    if (convergence->count == convergence->capacity) {
+        int newCapacity = convergence->capacity == 0 ? 64 : convergence->capacity * 2;
+        ConvergencePoint* points = (ConvergencePoint*)realloc(convergence->points, sizeof(ConvergencePoint) * (size_t)newCapacity);
+        if (points == NULL) return;
+        convergence->points = points;
+        convergence->capacity = newCapacity;
+    }
+    ConvergencePoint* point = &convergence->points[convergence->count++];
+    point->seconds = seconds;
+    point->onTime = score->onTime;
+    point->produced = score->produced;
+    point->plantDays = score->plantDays;
+    point->worker = worker;
+}
+
+// helper function to get the next number of a search thread's random sequence (xorshift64*)
+static uint64_t nextRandom(uint64_t* state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 2685821657736338717ULL;
+}
+
+// helper function to move the row at one position of a sequence to another, shifting the rows in between
+static void moveRow(int* rows, int from, int to) {
+    int row = rows[from];
+    if (from < to) {
+        memmove(rows + from, rows + from + 1, sizeof(int) * (size_t)(to - from));
+    } else {
+        memmove(rows + to + 1, rows + to, sizeof(int) * (size_t)(from - to));
+    }
+    rows[to] = row;
+}
+
+// function for a search thread of an OPT run: hill climbing over the sequence the plants take the orders in
+// each step swaps two orders or moves one to another place, which moves their segments to other plants and days;
+// the schedule is only redone from the first day the change reaches, and a step that makes it worse is undone
+static void* runSearchWorker(void* argument) {
+    SearchWorker* worker = (SearchWorker*)argument;
+    Search* search = worker->search;
+    const Snapshot* snapshot = &search->snapshot;
+    int orderCount = search->orderCount;
+    int* rows = (int*)malloc(sizeof(int) * (2 * (size_t)snapshot->orderCount + 1));
+    Schedule schedule;
+    memset(&schedule, 0, sizeof(schedule));
+    if (rows == NULL || !prepareSchedule(&schedule, snapshot->plantCount, snapshot->orderCount)) {
+        free(rows);
+        freeSchedule(&schedule);
+        worker->ok = false;
+        return NULL;
+    }
+
+    memcpy(rows, search->starts[worker->id % 3], sizeof(int) * (size_t)orderCount);
+    schedule.idleDay = INT_MAX;
+    truncateSchedule(&schedule, 0);
+    bool ok = continueSequence(snapshot, &schedule, rows, orderCount, false);
+    Score current = scoreSchedule(snapshot, &schedule);
+    uint64_t state = 0x9E3779B97F4A7C15ULL * (uint64_t)(worker->id + 1);
+
+    while (ok && orderCount >= 2 && secondsSince(&search->start) < search->budget) {
+        int a = (int)(nextRandom(&state) % (uint64_t)orderCount);
+        int b = (int)(nextRandom(&state) % (uint64_t)(orderCount - 1));
+        if (b >= a) b++;
+        bool swap = nextRandom(&state) & 1;
+        if (swap) {
+            int row = rows[a];
+            rows[a] = rows[b];
+            rows[b] = row;
+        } else {
+            moveRow(rows, a, b);
+        }
+
+        ok = continueSequence(snapshot, &schedule, rows, orderCount, true);
+        Score score = scoreSchedule(snapshot, &schedule);
+        int better = compareScores(&score, &current);
+        if (better < 0) {
+            if (swap) {
+                int row = rows[a];
+                rows[a] = rows[b];
+                rows[b] = row;
+            } else {
+                moveRow(rows, b, a);
+            }
+            ok = ok && continueSequence(snapshot, &schedule, rows, orderCount, true);
+            continue;
+        }
+        current = score;
+        if (better == 0) continue;
+
+        pthread_mutex_lock(&search->lock);
+        if (compareScores(&current, &search->best) > 0) {
+            search->best = current;
+            memcpy(search->bestRows, rows, sizeof(int) * (size_t)orderCount);
+            addConvergence(search->convergence, secondsSince(&search->start), &current, worker->id);
+        }
+        pthread_mutex_unlock(&search->lock);
+    }
+
+    worker->ok = ok;
+    freeSchedule(&schedule);
+    free(rows);
+    return NULL;
+}
+
+// helper function to assign orders to plants by searching for a better sequence than FCFS, EDF and SJF give
+// every core runs its own hill climbing from one of those sequences for the time budget, and the best sequence
+// any of them finds is laid out like FCFS lays out its sequence
+static bool assignOrdersToPlantsOPT(const Snapshot* snapshot, Schedule* schedule, bool extend) {
+    (void)extend;   // the search starts over on every run
+    if (!prepareSchedule(schedule, snapshot->plantCount, snapshot->orderCount)) return false;
+
+    int orderCount;
+    int* rows = admitOrders(snapshot, schedule, false, false, &orderCount);
+    Search* search = (Search*)calloc(1, sizeof(Search));
+    int* sequences = (int*)malloc(sizeof(int) * (4 * (size_t)orderCount + 1));
+    long long* keys = (long long*)malloc(sizeof(long long) * ((size_t)orderCount + 1));
+    if (rows == NULL || search == NULL || sequences == NULL || keys == NULL) {
+        free(rows);
+        free(search);
+        free(sequences);
+        free(keys);
+        return false;
+    }
+
+    // the starting sequences: arrival order, due order and shortest first
+    int* arrival = sequences;
+    int* due = arrival + orderCount;
+    int* shortest = due + orderCount;
+    search->bestRows = shortest + orderCount;
+    memcpy(arrival, rows, sizeof(int) * (size_t)orderCount);
+    for (int i = 0; i < orderCount; i++) keys[i] = sortKey(snapshot->due_day[rows[i]], rows[i]);
+    qsort(keys, (size_t)orderCount, sizeof(long long), compareDueKeys);
+    for (int i = 0; i < orderCount; i++) due[i] = (int)(keys[i] & 0xffffffff);
+    for (int i = 0; i < orderCount; i++) keys[i] = sortKey(snapshot->quantity[rows[i]], rows[i]);
+    qsort(keys, (size_t)orderCount, sizeof(long long), compareDueKeys);
+    for (int i = 0; i < orderCount; i++) shortest[i] = (int)(keys[i] & 0xffffffff);
+    free(keys);
+
+    search->snapshot = *snapshot;
+    search->snapshot.stats = NULL;
+    search->orderCount = orderCount;
+    search->budget = snapshot->optBudget / 1000.0;
+    search->convergence = snapshot->convergence;
+    if (search->convergence != NULL) search->convergence->count = 0;
+    pthread_mutex_init(&search->lock, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &search->start);
+
+    // lay out each starting sequence in the schedule, best first
+    const int* candidates[3] = {arrival, due, shortest};
+    Score scores[3];
+    bool ok = true;
+    for (int c = 0; c < 3 && ok; c++) {
+        schedule->idleDay = INT_MAX;
+        truncateSchedule(schedule, 0);
+        memcpy(rows, candidates[c], sizeof(int) * (size_t)orderCount);
+        ok = continueSequence(&search->snapshot, schedule, rows, orderCount, false);
+        scores[c] = scoreSchedule(snapshot, schedule);
+    }
+    int first = 0;
+    for (int c = 1; c < 3; c++) {
+        if (compareScores(&scores[c], &scores[first]) > 0) first = c;
+    }
+    for (int c = 0; c < 3; c++) search->starts[c] = candidates[(first + c) % 3];
+    search->best = scores[first];
+    memcpy(search->bestRows, candidates[first], sizeof(int) * (size_t)orderCount);
+    addConvergence(search->convergence, secondsSince(&search->start), &search->best, -1);
+
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    int workerCount = processors > 0 ? (int)processors : 1;
+    if (workerCount > OPT_THREADS) workerCount = OPT_THREADS;
+    SearchWorker workers[OPT_THREADS];
+    pthread_t threads[OPT_THREADS];
+    bool started[OPT_THREADS];
+    for (int w = 0; w < workerCount && ok; w++) {
+        workers[w].search = search;
+        workers[w].id = w;
+        workers[w].ok = true;
+        started[w] = w > 0 && pthread_create(&threads[w], NULL, runSearchWorker, &workers[w]) == 0;
+    }
+    if (ok) runSearchWorker(&workers[0]);
+    for (int w = 1; w < workerCount && ok; w++) {
+        if (started[w]) pthread_join(threads[w], NULL);
+    }
+    pthread_mutex_destroy(&search->lock);
+
+    // lay out the best sequence found (the schedule keeps it, so a later OPT run could be compared with it)
+    schedule->idleDay = INT_MAX;
+    truncateSchedule(schedule, 0);
+    memcpy(rows, search->bestRows, sizeof(int) * (size_t)orderCount);
+    ok = ok && continueSequence(snapshot, schedule, rows, orderCount, false);
+
+    free(sequences);
+    free(search);
+    free(rows);
+    return ok;
+}
+
+// helper function to count the product switches of a schedule, over every plant or for one plant
+// (each plant's segments are in day order, so a switch is a segment whose product differs from the plant's previous one)
+static int countChangeovers(const Schedule* schedule, const int* product_id, int plant) {
+    int* lastProduct = (int*)malloc(sizeof(int) * ((size_t)schedule->plantCount + 1));
+    if (lastProduct == NULL) return 0;
+    for (int k = 0; k < schedule->plantCount; k++) lastProduct[k] = -1;
+
+    int changeovers = 0;
+    for (int i = 0; i < schedule->count; i++) {
+        const Segment* segment = &schedule->segments[i];
+        int p = product_id[segment->order];
+        if (plant >= 0 && segment->plant != plant) continue;
+        if (lastProduct[segment->plant] >= 0 && lastProduct[segment->plant] != p) changeovers++;
+        lastProduct[segment->plant] = p;
+    }
+    free(lastProduct);
+    return changeovers;
+}
+
+// helper function to run the named algorithm on a snapshot, false for an unknown name or when out of memory
+// a schedule the same algorithm built for the same plants and period, with fewer orders, is extended rather than rebuilt
+static bool runAlgorithm(const char* algorithm, const Snapshot* snapshot, Schedule* schedule) {
+    bool (*assign)(const Snapshot*, Schedule*, bool) = NULL;
+    if (strcasecmp(algorithm, "FCFS") == 0) {
+        assign = assignOrdersToPlantsFCFS;
+    } else if (strcasecmp(algorithm, "SJF") == 0) {
+        assign = assignOrdersToPlantsSJF;
+    } else if (strcasecmp(algorithm, "EDF") == 0) {
+        assign = assignOrdersToPlantsEDF;
+    } else if (strcasecmp(algorithm, "GROUP") == 0) {
+        assign = assignOrdersToPlantsGROUP;
+    } else if (strcasecmp(algorithm, "OPT") == 0) {
+        assign = assignOrdersToPlantsOPT;
+    } else {
+        return false;
+    }
+
+    bool extend = strcasecmp(schedule->algorithm, algorithm) == 0 && schedule->setup == snapshot->setup &&
+                  schedule->orderCount <= snapshot->orderCount;
+    schedule->algorithm[0] = '\0';
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    bool ok = assign(snapshot, schedule, extend);
+    schedule->seconds = secondsSince(&start);
+    statsRecord(snapshot->stats, PHASE_RUN, (long long)(schedule->seconds * 1e9));
+
+    if (ok) {
+        snprintf(schedule->algorithm, sizeof(schedule->algorithm), "%s", algorithm);
+        schedule->setup = snapshot->setup;
+    }
+    return ok;
+}
+
+// function to print how the best schedule of the last OPT run improved over time
+static void printConvergence(pls_context* ctx) {
+    if (ctx->traceLevel < PLS_TRACE_REJECTIONS) return;
+
+    const Convergence* convergence = &ctx->convergence;
+    message(ctx, "OPT search: %d improvements in %d ms.\n", convergence->count > 0 ? convergence->count - 1 : 0, ctx->optBudget);
+    for (int i = 0; i < convergence->count; i++) {
+        const ConvergencePoint* point = &convergence->points[i];
+        if (point->worker < 0) {
+            message(ctx, "  %8.3f ms: %lld units on time, %lld produced, %d plant days (best starting sequence)\n",
+                point->seconds * 1000, point->onTime, point->produced, point->plantDays);
+        } else {
+            message(ctx, "  %8.3f ms: %lld units on time, %lld produced, %d plant days (search thread %d)\n",
+                point->seconds * 1000, point->onTime, point->produced, point->plantDays, point->worker);
+        }
+    }
+}
+
+// helper function to fold a block of memory into a checksum 8 bytes at a time (FNV-1a over 64-bit words, a short tail is zero padded)
+static uint64_t checksumWords(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    uint64_t word;
+    for (; size >= 8; bytes += 8, size -= 8) {
+        memcpy(&word, bytes, 8);
+        hash = (hash ^ word) * 1099511628211ULL;
+    }
+    if (size > 0) {
+        word = 0;
+        memcpy(&word, bytes, size);
+        hash = (hash ^ word) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+// helper function to write one section of a snapshot padded to 8 bytes
+static bool writeSection(FILE* file, const void* data, uint64_t size) {
+    static const char padding[8] = {0};
+    size_t pad = (size_t)(-size & 7);
+    if (size > 0 && fwrite(data, 1, (size_t)size, file) != size) return false;
+    return pad == 0 || fwrite(padding, 1, pad, file) == pad;
+}
+
+// constant values of the schedule cache files (the layout is that of this build, so the version changes with it)
+#define CACHE_MAGIC "PLSCACH"
+#define CACHE_VERSION 1
+
+// a structure for the header of a cached schedule file; the segments, plant state, rejected rows, due keys, sequence
+// and SJF steps follow in that order, each padded to 8 bytes, and the checksum covers the header (with the checksum
+// field zero) and all of them
+typedef struct CacheHeader {
+    char magic[8];
+    uint32_t version, headerSize;
+    uint64_t key, checksum, fileSize;
+    char algorithm[8];
+    int32_t plantCount, segmentCount, orderCount, rejectedCount;
+    int32_t sequenceCount, idleDay, stepCount, reserved;
+    double seconds;
+} CacheHeader;
+
+_Static_assert(sizeof(CacheHeader) % 8 == 0, "cached schedule sections must stay 8-byte aligned");
+
+// helper function to work out the fingerprint of everything a run of an algorithm depends on: the orders, the period,
+// the plants, the calendar, and the changeover days or the search budget for the algorithms that use them
+static uint64_t scheduleKey(const pls_context* ctx, const char* algorithm) {
+    char name[8] = {0};
+    for (int i = 0; i < 7 && algorithm[i] != '\0'; i++) name[i] = (char)toupper((unsigned char)algorithm[i]);
+    int settings[6] = {
+        ctx->orders.count, ctx->period.start_day, ctx->numberOfDays, ctx->plants.count,
+        strcmp(name, "GROUP") == 0 ? ctx->changeover : 0, strcmp(name, "OPT") == 0 ? ctx->optBudget : 0
+    };
+
+    uint64_t key = checksumWords(ctx->orderHash, name, sizeof(name));
+    key = checksumWords(key, settings, sizeof(settings));
+    for (int k = 0; k < ctx->plants.count; k++) {
+        key = checksumWords(key, ctx->plants.name[k], strlen(ctx->plants.name[k]) + 1);
+    }
+    key = checksumWords(key, ctx->plants.capacity, sizeof(int) * (size_t)ctx->plants.count);
+    return checksumWords(key, ctx->downtime, sizeof(Downtime) * (size_t)ctx->downtimeCount);
+}
+
+// helper function to copy an array that may be empty (and NULL)
+static void copyArray(void* to, const void* from, size_t size) {
+    if (size > 0) memcpy(to, from, size);
+}
+
+// helper function to make a copy of a schedule with memory of its own, false when out of memory
+static bool copySchedule(Schedule* copy, const Schedule* schedule) {
+    memset(copy, 0, sizeof(Schedule));
+    int plantCount = schedule->plantCount, orderCount = schedule->orderCount;
+    copy->segments = (Segment*)malloc(sizeof(Segment) * ((size_t)schedule->count + 1));
+    copy->rejected = (int*)malloc(sizeof(int) * ((size_t)schedule->rejectedCount + 1));
+    copy->plantOrder = (int*)malloc(sizeof(int) * (4 * (size_t)plantCount + 1));
+    copy->dueKeys = (long long*)malloc(sizeof(long long) * ((size_t)orderCount + 1));
+    copy->sequence = (int*)malloc(sizeof(int) * ((size_t)orderCount + 1));
+    copy->steps = (Step*)malloc(sizeof(Step) * ((size_t)schedule->stepCount + 1));
+    if (copy->segments == NULL || copy->rejected == NULL || copy->plantOrder == NULL || copy->dueKeys == NULL ||
+        copy->sequence == NULL || copy->steps == NULL) {
+        freeSchedule(copy);
+        return false;
+    }
+
+    copyArray(copy->segments, schedule->segments, sizeof(Segment) * (size_t)schedule->count);
+    copyArray(copy->rejected, schedule->rejected, sizeof(int) * (size_t)schedule->rejectedCount);
+    copyArray(copy->plantOrder, schedule->plantOrder, sizeof(int) * 4 * (size_t)plantCount);
+    if (schedule->dueKeys != NULL) copyArray(copy->dueKeys, schedule->dueKeys, sizeof(long long) * (size_t)orderCount);
+    copyArray(copy->sequence, schedule->sequence, sizeof(int) * (size_t)schedule->sequenceCount);
+    copyArray(copy->steps, schedule->steps, sizeof(Step) * (size_t)schedule->stepCount);
+    copy->count = copy->capacity = schedule->count;
+    copy->plantCount = plantCount;
+    copy->lastSegment = copy->plantOrder + plantCount;
+    copy->days = copy->lastSegment + plantCount;
+    copy->produce = copy->days + plantCount;
+    copy->orderCount = copy->orderCapacity = orderCount;
+    copy->rejectedCount = copy->rejectedCapacity = schedule->rejectedCount;
+    copy->seconds = schedule->seconds;
+    memcpy(copy->algorithm, schedule->algorithm, sizeof(copy->algorithm));
+    copy->setup = schedule->setup;
+    copy->sequenceCount = schedule->sequenceCount;
+    copy->idleDay = schedule->idleDay;
+    copy->stepCount = copy->stepCapacity = schedule->stepCount;
+    return true;
+}
+
+// helper function to drop every schedule of the cache
+static void clearCache(pls_context* ctx) {
+    for (int i = 0; i < CACHE_ENTRIES; i++) {
+        freeSchedule(&ctx->cache[i].schedule);
+    }
+}
+
+// helper function to get the name of the file a schedule is cached in, false if it does not fit
+static bool cacheFileName(const pls_context* ctx, uint64_t key, char* fileName, size_t size) {
+    return snprintf(fileName, size, "%s/%016llx.plscache", ctx->cacheDir, (unsigned long long)key) < (int)size;
+}
+
+// helper function to work out the sizes of the sections of a cached schedule from its header
+static void cacheSections(const CacheHeader* header, uint64_t* sizes) {
+    sizes[0] = (uint64_t)header->segmentCount * sizeof(Segment);
+    sizes[1] = 4 * (uint64_t)header->plantCount * sizeof(int);
+    sizes[2] = (uint64_t)header->rejectedCount * sizeof(int);
+    sizes[3] = (uint64_t)header->orderCount * sizeof(long long);
+    sizes[4] = (uint64_t)header->sequenceCount * sizeof(int);
+    sizes[5] = (uint64_t)header->stepCount * sizeof(Step);
+}
+
+// helper function to write a schedule into the cache directory
+// (written next to the file and renamed over it, so a reader never sees half a file)
+static void writeCacheFile(pls_context* ctx, uint64_t key, const Schedule* schedule) {
+    CacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.headerSize = sizeof(CacheHeader);
+    header.key = key;
+    memcpy(header.algorithm, schedule->algorithm, sizeof(header.algorithm));
+    header.plantCount = schedule->plantCount;
+    header.segmentCount = schedule->count;
+    header.orderCount = schedule->orderCount;
+    header.rejectedCount = schedule->rejectedCount;
+    header.sequenceCount = schedule->sequenceCount;
+    header.idleDay = schedule->idleDay;
+    header.stepCount = schedule->stepCount;
+    header.seconds = schedule->seconds;
+
+    const void* data[6] = {schedule->segments, schedule->plantOrder, schedule->rejected, schedule->dueKeys, schedule->sequence, schedule->steps};
+    uint64_t sizes[6];
+    cacheSections(&header, sizes);
+    header.fileSize = sizeof(CacheHeader);
+    for (int i = 0; i < 6; i++) header.fileSize += (sizes[i] + 7) & ~(uint64_t)7;
+    uint64_t checksum = checksumWords(14695981039346656037ULL, &header, sizeof(header));
+    for (int i = 0; i < 6; i++) checksum = checksumWords(checksum, data[i], (size_t)sizes[i]);
+    header.checksum = checksum;
+
+    char fileName[512], temporary[520];
+    if (!cacheFileName(ctx, key, fileName, sizeof(fileName))) {
+        message(ctx, "Cache directory %s is too long.\n", ctx->cacheDir);
+        return;
+    }
+    snprintf(temporary, sizeof(temporary), "%s.tmp", fileName);
+    FILE* file = fopen(temporary, "wb");
+    if (file == NULL) {
+        message(ctx, "Error opening cache file %s.\n", temporary);
+        return;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (int i = 0; i < 6 && ok; i++) {
+        ok = writeSection(file, data[i], sizes[i]);
+    }
+    ok = fclose(file) == 0 && ok;
+    if (!ok || rename(temporary, fileName) != 0) {
+        remove(temporary);
+        message(ctx, "Error writing cache file %s.\n", fileName);
+    }
+}
+
+// helper function to check that the plants and order rows a schedule read from a file refers to are in range
+// (segments, the plant order, the last segment of each plant, rejected rows, sorted due keys and the run sequence)
+static bool scheduleRowsValid(const Segment* segments, int segmentCount, const int* plantOrder, int plantCount,
+                              const int* rejected, int rejectedCount, const long long* dueKeys, int keyCount,
+                              const int* sequence, int sequenceCount, int orderCount) {
+    for (int i = 0; i < segmentCount; i++) {
+        const Segment* segment = &segments[i];
+        if (segment->plant < 0 || segment->plant >= plantCount || segment->order < 0 || segment->order >= orderCount) return false;
+    }
+    for (int i = 0; i < plantCount; i++) {
+        if (plantOrder[i] < 0 || plantOrder[i] >= plantCount) return false;
+        if (plantOrder[plantCount + i] < -1 || plantOrder[plantCount + i] >= segmentCount) return false;
+    }
+    for (int i = 0; i < rejectedCount; i++) {
+        if (rejected[i] < 0 || rejected[i] >= orderCount) return false;
+    }
+    for (int i = 0; i < keyCount; i++) {
+        if ((dueKeys[i] & 0xffffffff) >= (unsigned)orderCount) return false;
+    }
+    for (int i = 0; i < sequenceCount; i++) {
+        if (sequence[i] < 0 || sequence[i] >= orderCount) return false;
+    }
+    return true;
+}
+
+// helper function to read a schedule from the cache directory, false if it is not there or does not fit the context
+static bool readCacheFile(pls_context* ctx, uint64_t key, Schedule* schedule) {
+    char fileName[512];
+    if (ctx->cacheDir[0] == '\0' || !cacheFileName(ctx, key, fileName, sizeof(fileName))) return false;
+    FILE* file = fopen(fileName, "rb");
+    if (file == NULL) return false;
+
+    struct stat info;
+    char* buffer = NULL;
+    bool ok = fstat(fileno(file), &info) == 0 && (size_t)info.st_size >= sizeof(CacheHeader) &&
+              (buffer = (char*)malloc((size_t)info.st_size)) != NULL && fread(buffer, 1, (size_t)info.st_size, file) == (size_t)info.st_size;
+    fclose(file);
+
+    CacheHeader header;
+    uint64_t sizes[6], offset = sizeof(CacheHeader);
+    if (ok) {
+        memcpy(&header, buffer, sizeof(header));
+        uint64_t checksum = header.checksum;
+        memset(buffer + offsetof(CacheHeader, checksum), 0, sizeof(header.checksum));
+        ok = memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0 && header.version == CACHE_VERSION &&
+             header.headerSize == sizeof(CacheHeader) && header.key == key && header.fileSize == (uint64_t)info.st_size &&
+             checksumWords(14695981039346656037ULL, buffer, (size_t)info.st_size) == checksum &&
+             header.plantCount == ctx->plants.count && header.orderCount == ctx->orders.count &&
+             header.segmentCount >= 0 && header.rejectedCount >= 0 && header.sequenceCount >= 0 && header.stepCount >= 0 &&
+             header.rejectedCount <= header.orderCount && header.sequenceCount <= header.orderCount;
+    }
+    if (ok) {
+        cacheSections(&header, sizes);
+        for (int i = 0; i < 6; i++) offset += (sizes[i] + 7) & ~(uint64_t)7;
+        ok = offset == header.fileSize;
+    }
+    if (!ok) {
+        free(buffer);
+        message(ctx, "Cache file %s is not a valid cached schedule, ignored.\n", fileName);
+        return false;
+    }
+
+    // a view of the schedule in the buffer, copied out once its rows and plants are known to fit the context
+    Schedule view;
+    memset(&view, 0, sizeof(view));
+    void** targets[6] = {(void**)&view.segments, (void**)&view.plantOrder, (void**)&view.rejected, (void**)&view.dueKeys, (void**)&view.sequence, (void**)&view.steps};
+    offset = sizeof(CacheHeader);
+    for (int i = 0; i < 6; i++) {
+        *targets[i] = buffer + offset;
+        offset += (sizes[i] + 7) & ~(uint64_t)7;
+    }
+    int plantCount = header.plantCount, orderCount = header.orderCount;
+    ok = scheduleRowsValid(view.segments, header.segmentCount, view.plantOrder, plantCount, view.rejected, header.rejectedCount,
+                           view.dueKeys, orderCount, view.sequence, header.sequenceCount, orderCount);
+    if (!ok) {
+        free(buffer);
+        message(ctx, "Cache file %s is not a valid cached schedule, ignored.\n", fileName);
+        return false;
+    }
+
+    view.count = header.segmentCount;
+    view.plantCount = plantCount;
+    view.lastSegment = view.plantOrder + plantCount;
+    view.days = view.lastSegment + plantCount;
+    view.produce = view.days + plantCount;
+    view.orderCount = orderCount;
+    view.rejectedCount = header.rejectedCount;
+    view.seconds = header.seconds;
+    memcpy(view.algorithm, header.algorithm, sizeof(view.algorithm));
+    view.algorithm[sizeof(view.algorithm) - 1] = '\0';
+    view.sequenceCount = header.sequenceCount;
+    view.idleDay = header.idleDay;
+    view.stepCount = header.stepCount;
+    ok = copySchedule(schedule, &view);
+    free(buffer);
+    return ok;
+}
+
+// helper function to find the cache entry to put a new schedule in: a free one, or else the least recently used
+static CacheEntry* cacheSlot(pls_context* ctx) {
+    CacheEntry* slot = &ctx->cache[0];
+    for (int i = 0; i < CACHE_ENTRIES; i++) {
+        CacheEntry* entry = &ctx->cache[i];
+        if (entry->schedule.algorithm[0] == '\0') return entry;
+        if (entry->lastUsed < slot->lastUsed) slot = entry;
+    }
+    return slot;
+}
+
+// helper function to make a cached schedule of the given inputs the last schedule, looking in memory first and then on disk
+static bool loadCached(pls_context* ctx, uint64_t key, const char* algorithm, const Snapshot* snapshot) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    CacheEntry* found = NULL;
+    for (int i = 0; i < CACHE_ENTRIES && found == NULL; i++) {
+        if (ctx->cache[i].schedule.algorithm[0] != '\0' && ctx->cache[i].key == key) found = &ctx->cache[i];
+    }
+    Schedule restored;
+    bool fromDisk = false;
+    if (found != NULL) {
+        if (!copySchedule(&restored, &found->schedule)) return false;
+    } else {
+        if (!readCacheFile(ctx, key, &restored)) {
+            if (snapshot->stats != NULL) snapshot->stats->cacheMisses++;
+            return false;
+        }
+        // a schedule found on disk is kept in memory too, so the next run does not read it again
+        fromDisk = true;
+        found = cacheSlot(ctx);
+        freeSchedule(&found->schedule);
+        if (copySchedule(&found->schedule, &restored)) {
+            found->key = key;
+        } else {
+            found = NULL;
+        }
+    }
+    if (found != NULL) found->lastUsed = ++ctx->cacheClock;
+
+    freeSchedule(&ctx->lastSchedule);
+    ctx->lastSchedule = restored;
+    snprintf(ctx->lastSchedule.algorithm, sizeof(ctx->lastSchedule.algorithm), "%s", algorithm);
+    ctx->lastSchedule.setup = snapshot->setup;
+    ctx->lastSchedule.seconds = secondsSince(&start);
+    if (snapshot->stats != NULL) {
+        snapshot->stats->cacheHits++;
+        if (fromDisk) snapshot->stats->cacheDiskHits++;
+    }
+    return true;
+}
+
+// helper function to keep the last schedule in the cache under the fingerprint of its inputs, and on disk if asked
+static void storeCached(pls_context* ctx, uint64_t key) {
+    CacheEntry* entry = cacheSlot(ctx);
+    freeSchedule(&entry->schedule);
+    if (!copySchedule(&entry->schedule, &ctx->lastSchedule)) return;
+    entry->key = key;
+    entry->lastUsed = ++ctx->cacheClock;
+    if (ctx->cacheDir[0] != '\0') writeCacheFile(ctx, key, &ctx->lastSchedule);
+}
+
+// function to schedule the orders with one algorithm
+// (a run on the same orders, period, plants and calendar as a cached one takes the cached schedule instead)
+static bool scheduleOrders(pls_context* ctx, const char* algorithm) {
+    ctx->lastAlgorithm[0] = '\0';
+
+    Snapshot snapshot = takeSnapshot(ctx);
+    snapshot.convergence = &ctx->convergence;
+    uint64_t key = ctx->cacheEnabled ? scheduleKey(ctx, algorithm) : 0;
+    bool cached = ctx->cacheEnabled && loadCached(ctx, key, algorithm, &snapshot);
+    if (!cached) {
+        if (!runAlgorithm(algorithm, &snapshot, &ctx->lastSchedule)) {
+            message(ctx, "Out of memory. Schedule not computed.\n");
+            return false;
+        }
+        if (ctx->cacheEnabled) storeCached(ctx, key);
+    }
+    snprintf(ctx->lastAlgorithm, sizeof(ctx->lastAlgorithm), "%s", algorithm);
+
+    struct timespec start;
+    statsStart(snapshot.stats, &start);
+    if (cached && ctx->traceLevel >= PLS_TRACE_REJECTIONS) message(ctx, "Schedule taken from the cache (nothing it depends on has changed).\n");
+    printRejections(ctx, &ctx->lastSchedule);
+    if (strcasecmp(algorithm, "OPT") == 0 && !cached) printConvergence(ctx);
+    printScheduleTrace(ctx, &ctx->lastSchedule, &snapshot);
+    statsStop(snapshot.stats, PHASE_TRACE, &start);
+
+    dumpStats(ctx, algorithm);
+    return true;
+}
+
+// number of algorithms a comparison run covers
+#define ALGORITHM_COUNT 4
+
+// a structure for one algorithm of a comparison run
+typedef struct AlgorithmRun {
+    const char* algorithm;
+    Snapshot snapshot;          // a copy per run, pointing at the run's own statistics
+    Stats stats;
+    Schedule schedule;
+    bool ok;
+} AlgorithmRun;
+
+// helper function for a comparison thread to run its algorithm
+static void* runAlgorithmThread(void* argument) {
+    AlgorithmRun* run = (AlgorithmRun*)argument;
+    run->ok = runAlgorithm(run->algorithm, &run->snapshot, &run->schedule);
+    return NULL;
+}
+
+// function to run every algorithm on the same snapshot in parallel and write a comparison report
+static bool compareAlgorithms(pls_context* ctx, const char* fileName) {
+
+    Snapshot snapshot = takeSnapshot(ctx);
+    static const char* const algorithms[ALGORITHM_COUNT] = {"FCFS", "SJF", "EDF", "GROUP"};
+    AlgorithmRun runs[ALGORITHM_COUNT];
+    memset(runs, 0, sizeof(runs));
+    for (int i = 0; i < ALGORITHM_COUNT; i++) {
+        runs[i].algorithm = algorithms[i];
+        runs[i].snapshot = snapshot;
+        runs[i].snapshot.stats = snapshot.stats != NULL ? &runs[i].stats : NULL;
+    }
+    pthread_t threads[ALGORITHM_COUNT];
+    bool started[ALGORITHM_COUNT];
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < ALGORITHM_COUNT; i++) {
+        started[i] = pthread_create(&threads[i], NULL, runAlgorithmThread, &runs[i]) == 0;
+        if (!started[i]) runAlgorithmThread(&runs[i]);
+    }
+    for (int i = 0; i < ALGORITHM_COUNT; i++) {
+        if (started[i]) pthread_join(threads[i], NULL);
+    }
+    double wallTime = secondsSince(&start);
+    for (int i = 0; i < ALGORITHM_COUNT && snapshot.stats != NULL; i++) {
+        mergeStats(snapshot.stats, &runs[i].stats);
+    }
+
+    FILE* report_file = fopen(fileName, "w");
+    if (report_file == NULL) {
+        message(ctx, "Error opening report file.\n");
+    } else {
+        fprintf(report_file, "***PLS Algorithm Comparison Report***\n");
+        fprintf(report_file, "Scheduling period: %s to %s (%d days), %d orders, %d plants\n\n", ctx->period.start_date, ctx->period.end_date, snapshot.numDays, snapshot.orderCount, snapshot.plantCount);
+
+        fprintf(report_file, "ALGORITHM ACCEPTED REJECTED PRODUCED UTILIZATION CHANGEOVERS TIME\n");
+        fprintf(report_file, "===========================================================================\n");
+        for (int i = 0; i < ALGORITHM_COUNT; i++) {
+            const Schedule* schedule = &runs[i].schedule;
+            if (!runs[i].ok) {
+                fprintf(report_file, "%s not computed (out of memory)\n", runs[i].algorithm);
+                continue;
+            }
+            long long produced = 0;
+            for (int k = 0; k < schedule->plantCount; k++) produced += schedule->produce[k];
+            fprintf(report_file, "%s %d %d %lld %.2f %% %d %.3f ms\n", runs[i].algorithm, snapshot.orderCount - schedule->rejectedCount, schedule->rejectedCount, produced, utilization(schedule, snapshot.capacity, -1) * 100, countChangeovers(schedule, snapshot.product_id, -1), schedule->seconds * 1000);
+        }
+        fprintf(report_file, "- End -\n");
+        fprintf(report_file, "===========================================================================\n\n");
+
+        fprintf(report_file, "PLANT UTILIZATION (FCFS SJF EDF GROUP)\n");
+        fprintf(report_file, "===========================================================================\n");
+        for (int k = 0; k < snapshot.plantCount; k++) {
+            fprintf(report_file, "%s", ctx->plants.name[k]);
+            for (int i = 0; i < ALGORITHM_COUNT; i++) {
+                fprintf(report_file, " %.2f %%", runs[i].ok ? utilization(&runs[i].schedule, snapshot.capacity, k) * 100 : 0.0);
+            }
+            fprintf(report_file, "\n");
+        }
+        fprintf(report_file, "- End -\n");
+        fprintf(report_file, "===========================================================================\n\n");
+
+        fprintf(report_file, "Total wall time for all algorithms: %.3f ms\n", wallTime * 1000);
+        fclose(report_file);
+        message(ctx, "Report generated successfully.\n");
+    }
+
+    for (int i = 0; i < ALGORITHM_COUNT; i++) {
+        freeSchedule(&runs[i].schedule);
+    }
+    dumpStats(ctx, "ALL");
+    return report_file != NULL;
+}
+
+// constant values of capacity sweeps
+#define SWEEP_DIMENSIONS 8
+#define SWEEP_VALUES 64
+#define SWEEP_SCENARIOS 10000
+#define SWEEP_THREADS 64
+
+// a structure for one axis of a sweep grid: a plant capacity (0 leaves the plant out) or a period
+typedef struct SweepDimension {
+    char name[PLANT_NAME];      // plant name, or PERIOD
+    int plant;                  // row of an existing plant, -1 for a plant the sweep adds or for the period
+    int count;
+    int capacity[SWEEP_VALUES];
+    int start_day[SWEEP_VALUES], numDays[SWEEP_VALUES];
+    char text[SWEEP_VALUES][2 * DATE];  // the value as given, for the report
+} SweepDimension;
+
+// a structure for the figures of one scenario
+typedef struct SweepResult {
+    bool ok;
+    int plantCount, numDays;
+    int accepted, rejected, changeovers;
+    long long produced;
+    double utilization, seconds;
+} SweepResult;
+
+// a structure for the queue of one worker: a range of scenarios it takes from the front while others steal from the back
+typedef struct SweepQueue {
+    pthread_mutex_t lock;
+    int next, end;
+} SweepQueue;
+
+// a structure for everything the workers of a sweep share
+typedef struct Sweep {
+    const char* algorithm;
+    Snapshot snapshot;          // orders and sorted keys shared by every scenario, read only
+    const SweepDimension* dimensions;
+    int dimensionCount, scenarioCount, workerCount;
+    SweepQueue queues[SWEEP_THREADS];
+    Stats stats[SWEEP_THREADS];
+    SweepResult* results;
+} Sweep;
+
+// a structure for a worker thread of a sweep
+typedef struct SweepWorker {
+    Sweep* sweep;
+    int id;
+} SweepWorker;
+
+// helper function to parse one NAME=value,value,... axis of a sweep grid
+static bool parseDimension(pls_context* ctx, const char* text, SweepDimension* dimension) {
+    const char* equals = strchr(text, '=');
+    if (equals == NULL || equals == text || (size_t)(equals - text) >= PLANT_NAME) {
+        message(ctx, "Invalid sweep axis '%s' (expected NAME=value,value,...).\n", text);
+        return false;
+    }
+    memcpy(dimension->name, text, (size_t)(equals - text));
+    dimension->name[equals - text] = '\0';
+    bool isPeriod = strcmp(dimension->name, "PERIOD") == 0;
+    dimension->plant = isPeriod ? -1 : findPlant(ctx, dimension->name);
+    dimension->count = 0;
+
+    const char* cursor = equals + 1;
+    while (*cursor) {
+        const char* end = strchr(cursor, ',');
+        if (end == NULL) end = cursor + strlen(cursor);
+        size_t length = (size_t)(end - cursor);
+        if (dimension->count == SWEEP_VALUES || length == 0 || length >= sizeof(dimension->text[0])) {
+            message(ctx, "Invalid values for sweep axis %s (at most %d).\n", dimension->name, SWEEP_VALUES);
+            return false;
+        }
+
+        int v = dimension->count;
+        memcpy(dimension->text[v], cursor, length);
+        dimension->text[v][length] = '\0';
+        if (isPeriod) {
+            int start_day, end_day;
+            if (length != 2 * DATE - 1 || cursor[DATE - 1] != ':' || !parseDate(cursor, DATE - 1, &start_day) ||
+                !parseDate(cursor + DATE, DATE - 1, &end_day)) {
+                message(ctx, "Invalid sweep period '%s' (expected YYYY-MM-DD:YYYY-MM-DD).\n", dimension->text[v]);
+                return false;
+            }
+            if (end_day < start_day) {
+                message(ctx, "Invalid sweep period '%s' (the end date is before the start date).\n", dimension->text[v]);
+                return false;
+            }
+            dimension->start_day[v] = start_day;
+            dimension->numDays[v] = end_day - start_day;
+        } else {
+            char* number_end;
+            long capacity = strtol(dimension->text[v], &number_end, 10);
+            if (*number_end != '\0' || capacity < 0 || capacity > INT_MAX) {
+                message(ctx, "Invalid capacity '%s' for plant %s.\n", dimension->text[v], dimension->name);
+                return false;
+            }
+            dimension->capacity[v] = (int)capacity;
+        }
+        dimension->count++;
+        cursor = *end == ',' ? end + 1 : end;
+    }
+    if (dimension->count == 0) {
+        message(ctx, "No values for sweep axis %s.\n", dimension->name);
+        return false;
+    }
+    return true;
+}
+
+// helper function to take the next scenario of a worker, stealing the later half of the fullest queue once its own is empty
+// (the fullest queue may have changed by the time it is locked, in which case the search starts over)
+static int takeScenario(Sweep* sweep, int id) {
+    SweepQueue* own = &sweep->queues[id];
+    pthread_mutex_lock(&own->lock);
+    int scenario = own->next < own->end ? own->next++ : -1;
+    pthread_mutex_unlock(&own->lock);
+    if (scenario >= 0) return scenario;
+
+    while (1) {
+        int victim = -1, most = 0;
+        for (int w = 0; w < sweep->workerCount; w++) {
+            if (w == id) continue;
+            pthread_mutex_lock(&sweep->queues[w].lock);
+            int left = sweep->queues[w].end - sweep->queues[w].next;
+            pthread_mutex_unlock(&sweep->queues[w].lock);
+            if (left > most) {
+                victim = w;
+                most = left;
+            }
+        }
+        if (victim < 0) return -1;
+
+        SweepQueue* other = &sweep->queues[victim];
+        pthread_mutex_lock(&other->lock);
+        int from = other->next + (other->end - other->next) / 2, to = other->end;
+        if (from < to) other->end = from;
+        pthread_mutex_unlock(&other->lock);
+        if (from >= to) continue;
+
+        // the first stolen scenario is run now, the rest go into the worker's own queue
+        pthread_mutex_lock(&own->lock);
+        own->next = from + 1;
+        own->end = to;
+        pthread_mutex_unlock(&own->lock);
+        return from;
+    }
+}
+
+// function for a sweep worker thread: builds the plants and period of each scenario it takes and schedules the shared orders
+static void* runSweepWorker(void* argument) {
+    SweepWorker* worker = (SweepWorker*)argument;
+    Sweep* sweep = worker->sweep;
+    const Snapshot* base = &sweep->snapshot;
+    int maxPlants = base->plantCount + sweep->dimensionCount;
+    int* capacity = (int*)malloc(sizeof(int) * 3 * (size_t)maxPlants);
+    Downtime* downtime = (Downtime*)malloc(sizeof(Downtime) * ((size_t)base->downtimeCount + 1));
+    Schedule schedule;
+    memset(&schedule, 0, sizeof(schedule));
+
+    int scenario;
+    while ((scenario = takeScenario(sweep, worker->id)) >= 0) {
+        SweepResult* result = &sweep->results[scenario];
+        if (capacity == NULL || downtime == NULL) continue;
+
+        // the scenario number is read as a mixed-radix number, one digit per axis, the first axis changing slowest
+        int* plantCapacity = capacity + maxPlants;
+        memcpy(plantCapacity, base->capacity, sizeof(int) * (size_t)base->plantCount);
+        int plantTotal = base->plantCount;
+        Snapshot snapshot = *base;
+        snapshot.stats = base->stats != NULL ? &sweep->stats[worker->id] : NULL;
+        int rest = scenario;
+        for (int d = sweep->dimensionCount - 1; d >= 0; d--) {
+            const SweepDimension* dimension = &sweep->dimensions[d];
+            int v = rest % dimension->count;
+            rest /= dimension->count;
+            if (strcmp(dimension->name, "PERIOD") == 0) {
+                snapshot.start_day = dimension->start_day[v];
+                snapshot.numDays = dimension->numDays[v];
+            } else if (dimension->plant >= 0) {
+                plantCapacity[dimension->plant] = dimension->capacity[v];
+            } else {
+                plantCapacity[plantTotal++] = dimension->capacity[v];
+            }
+        }
+
+        // plants at 0 are left out (this keeps them from ever being picked), and their downtime with them
+        int* plantIndex = plantCapacity + maxPlants;
+        int plantCount = 0;
+        for (int k = 0; k < plantTotal; k++) {
+            plantIndex[k] = plantCapacity[k] > 0 ? plantCount : -1;
+            if (plantCapacity[k] > 0) capacity[plantCount++] = plantCapacity[k];
+        }
+        int downtimeCount = 0;
+        for (int i = 0; i < base->downtimeCount; i++) {
+            int plant = base->downtime[i].plant;
+            if (plant >= 0 && plantIndex[plant] < 0) continue;
+            downtime[downtimeCount] = base->downtime[i];
+            downtime[downtimeCount++].plant = plant >= 0 ? plantIndex[plant] : -1;
+        }
+        snapshot.plantCount = plantCount;
+        snapshot.capacity = capacity;
+        snapshot.downtime = downtime;
+        snapshot.downtimeCount = downtimeCount;
+        snapshot.setup = scenario;
+        result->plantCount = plantCount;
+        result->numDays = snapshot.numDays;
+        if (plantCount == 0) continue;
+
+        // an empty algorithm name makes every scenario a full run rather than an extension of the last one
+        schedule.algorithm[0] = '\0';
+        result->ok = runAlgorithm(sweep->algorithm, &snapshot, &schedule);
+        if (!result->ok) continue;
+
+        result->accepted = schedule.orderCount - schedule.rejectedCount;
+        result->rejected = schedule.rejectedCount;
+        result->produced = 0;
+        for (int k = 0; k < schedule.plantCount; k++) result->produced += schedule.produce[k];
+        result->utilization = utilization(&schedule, capacity, -1);
+        result->changeovers = countChangeovers(&schedule, base->product_id, -1);
+        result->seconds = schedule.seconds;
+    }
+
+    freeSchedule(&schedule);
+    free(capacity);
+    free(downtime);
+    return NULL;
+}
+
+// function to evaluate every combination of plant capacities and periods in a grid on a pool of threads and write a table
+// each axis is NAME=value,value,... where NAME is an existing plant, a new plant, or PERIOD with YYYY-MM-DD:YYYY-MM-DD values
+static bool sweepScenarios(pls_context* ctx, const char* algorithm, const char* grid, const char* fileName) {
+    SweepDimension* dimensions = (SweepDimension*)malloc(sizeof(SweepDimension) * SWEEP_DIMENSIONS);
+    char* axes = strdup(grid);
+    if (dimensions == NULL || axes == NULL) {
+        free(dimensions);
+        free(axes);
+        message(ctx, "Out of memory. Sweep not run.\n");
+        return false;
+    }
+
+    int dimensionCount = 0;
+    long long scenarioCount = 1;
+    bool ok = true;
+    char* save;
+    for (char* axis = strtok_r(axes, " \t", &save); axis != NULL && ok; axis = strtok_r(NULL, " \t", &save)) {
+        if (dimensionCount == SWEEP_DIMENSIONS) {
+            message(ctx, "Too many sweep axes (at most %d).\n", SWEEP_DIMENSIONS);
+            ok = false;
+        } else if ((ok = parseDimension(ctx, axis, &dimensions[dimensionCount]))) {
+            scenarioCount *= dimensions[dimensionCount++].count;
+            if (scenarioCount > SWEEP_SCENARIOS) {
+                message(ctx, "Too many sweep scenarios (at most %d).\n", SWEEP_SCENARIOS);
+                ok = false;
+            }
+        }
+    }
+    free(axes);
+
+    Sweep* sweep = ok ? (Sweep*)calloc(1, sizeof(Sweep)) : NULL;
+    SweepResult* results = ok ? (SweepResult*)calloc((size_t)scenarioCount, sizeof(SweepResult)) : NULL;
+    long long* dueKeys = ok ? (long long*)malloc(sizeof(long long) * ((size_t)ctx->orders.count + 1)) : NULL;
+    if (ok && (sweep == NULL || results == NULL || dueKeys == NULL)) {
+        message(ctx, "Out of memory. Sweep not run.\n");
+        ok = false;
+    }
+    if (!ok) {
+        free(sweep);
+        free(results);
+        free(dueKeys);
+        free(dimensions);
+        return false;
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    // the orders are sorted by due day once, and every scenario admits from the same keys
+    Snapshot snapshot = takeSnapshot(ctx);
+    for (int row = 0; row < snapshot.orderCount; row++) {
+        dueKeys[row] = sortKey(snapshot.due_day[row], row);
+    }
+    qsort(dueKeys, (size_t)snapshot.orderCount, sizeof(long long), compareDueKeys);
+    snapshot.dueKeys = dueKeys;
+
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    int workerCount = processors > 0 ? (int)processors : 1;
+    if (workerCount > SWEEP_THREADS) workerCount = SWEEP_THREADS;
+    if (workerCount > scenarioCount) workerCount = (int)scenarioCount;
+
+    sweep->algorithm = algorithm;
+    sweep->snapshot = snapshot;
+    sweep->dimensions = dimensions;
+    sweep->dimensionCount = dimensionCount;
+    sweep->scenarioCount = (int)scenarioCount;
+    sweep->workerCount = workerCount;
+    sweep->results = results;
+    for (int w = 0; w < workerCount; w++) {
+        pthread_mutex_init(&sweep->queues[w].lock, NULL);
+        sweep->queues[w].next = (int)(scenarioCount * w / workerCount);
+        sweep->queues[w].end = (int)(scenarioCount * (w + 1) / workerCount);
+    }
+
+    SweepWorker workers[SWEEP_THREADS];
+    pthread_t threads[SWEEP_THREADS];
+    bool started[SWEEP_THREADS];
+    for (int w = 0; w < workerCount; w++) {
+        workers[w].sweep = sweep;
+        workers[w].id = w;
+        started[w] = w > 0 && pthread_create(&threads[w], NULL, runSweepWorker, &workers[w]) == 0;
+    }
+    // the calling thread is worker 0, and a worker that could not be started simply gets its scenarios stolen
+    runSweepWorker(&workers[0]);
+    for (int w = 1; w < workerCount; w++) {
+        if (started[w]) pthread_join(threads[w], NULL);
+    }
+    double wallTime = secondsSince(&start);
+    for (int w = 0; w < workerCount; w++) {
+        pthread_mutex_destroy(&sweep->queues[w].lock);
+        if (snapshot.stats != NULL) mergeStats(snapshot.stats, &sweep->stats[w]);
+    }
+
+    FILE* report_file = fopen(fileName, "w");
+    if (report_file == NULL) {
+        message(ctx, "Error opening report file.\n");
+    } else {
+        char separator = ctx->reportFormat == PLS_REPORT_CSV ? ',' : ctx->reportFormat == PLS_REPORT_TSV ? '\t' : ' ';
+        if (ctx->reportFormat == PLS_REPORT_TEXT) {
+            fprintf(report_file, "***PLS Capacity Sweep Report***\n");
+            fprintf(report_file, "Algorithm used: %s, %d orders, %d scenarios on %d threads\n\n", algorithm, snapshot.orderCount, sweep->scenarioCount, workerCount);
+        }
+        fprintf(report_file, "SCENARIO");
+        for (int d = 0; d < dimensionCount; d++) fprintf(report_file, "%c%s", separator, dimensions[d].name);
+        fprintf(report_file, "%cPLANTS%cDAYS%cACCEPTED%cREJECTED%cPRODUCED%cUTILIZATION%cCHANGEOVERS%cTIME(ms)\n",
+            separator, separator, separator, separator, separator, separator, separator, separator);
+        if (ctx->reportFormat == PLS_REPORT_TEXT) fprintf(report_file, "===========================================================================\n");
+
+        for (int i = 0; i < sweep->scenarioCount; i++) {
+            const SweepResult* result = &results[i];
+            fprintf(report_file, "%d", i + 1);
+            int rest = i;
+            int values[SWEEP_DIMENSIONS];
+            for (int d = dimensionCount - 1; d >= 0; d--) {
+                values[d] = rest % dimensions[d].count;
+                rest /= dimensions[d].count;
+            }
+            for (int d = 0; d < dimensionCount; d++) fprintf(report_file, "%c%s", separator, dimensions[d].text[values[d]]);
+            fprintf(report_file, "%c%d%c%d", separator, result->plantCount, separator, result->numDays);
+            if (!result->ok) {
+                fprintf(report_file, "%c%s\n", separator, result->plantCount == 0 ? "no plants" : "not computed (out of memory)");
+                continue;
+            }
+            fprintf(report_file, "%c%d%c%d%c%lld%c%.2f%s%c%d%c%.3f\n", separator, result->accepted, separator, result->rejected, separator,
+                result->produced, separator, result->utilization * 100, separator == ' ' ? " %" : "", separator, result->changeovers,
+                separator, result->seconds * 1000);
+        }
+        if (ctx->reportFormat == PLS_REPORT_TEXT) {
+            fprintf(report_file, "- End -\n");
+            fprintf(report_file, "===========================================================================\n\n");
+            fprintf(report_file, "Total wall time for all scenarios: %.3f ms\n", wallTime * 1000);
+        }
+        fclose(report_file);
+        message(ctx, "Report generated successfully.\n");
+    }
+
+    free(sweep);
+    free(results);
+    free(dueKeys);
+    free(dimensions);
+    dumpStats(ctx, "SWEEP");
+    return report_file != NULL;
+}
+
+// constant values of the snapshot file format (the layout is that of this build, so the version changes with it)
+#define SNAPSHOT_MAGIC "PLSSNAP"
+#define SNAPSHOT_VERSION 2
+
+// sections of a snapshot file, in file order
+enum {
+    SECTION_ORDER_NUMBER, SECTION_DUE_DAY, SECTION_QUANTITY, SECTION_PRODUCT_ID, SECTION_ORDER_INDEX,
+    SECTION_PRODUCT_NAME, SECTION_PRODUCT_INDEX, SECTION_PLANT_NAME, SECTION_PLANT_CAPACITY,
+    SECTION_SEGMENTS, SECTION_PLANT_STATE, SECTION_REJECTED, SECTION_DUE_KEYS, SECTION_SEQUENCE, SECTION_STEPS,
+    SECTION_DOWNTIME, SECTION_COUNT
+};
+
+// a structure for the header of a snapshot file; every section after it starts on an 8-byte boundary
+// and the checksum covers the header (with the checksum field zero) and all the sections
+typedef struct SnapshotHeader {
+    char magic[8];
+    uint32_t version, headerSize;
+    uint64_t fileSize, checksum;
+    uint64_t orderIndexCapacity, productIndexCapacity;
+    int32_t orderCount, productCount, plantCount, numberOfDays;
+    Period period;
+    char lastAlgorithm[8];
+    // the last schedule
+    char algorithm[8];          // empty when the schedule cannot be extended
+    int32_t plantStateCount, segmentCount, scheduleOrderCount, rejectedCount;
+    int32_t sequenceCount, idleDay, stepCount, downtimeCount;
+    double seconds;
+    uint64_t sectionOffset[SECTION_COUNT], sectionSize[SECTION_COUNT];
+} SnapshotHeader;
+
+_Static_assert(sizeof(SnapshotHeader) % 8 == 0, "snapshot sections must stay 8-byte aligned");
+
+// function to save the orders, period, plants and last schedule into a snapshot file
+// (written next to the file and renamed over it, so a snapshot that is still mapped stays intact)
+static bool saveSnapshot(pls_context* ctx, const char* file_name) {
+    const Schedule* schedule = &ctx->lastSchedule;
+    bool extendable = schedule->algorithm[0] != '\0' && schedule->setup == ctx->setup;
+
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version = SNAPSHOT_VERSION;
+    header.headerSize = sizeof(SnapshotHeader);
+    header.orderIndexCapacity = ctx->orders.indexCapacity;
+    header.productIndexCapacity = ctx->products.indexCapacity;
+    header.orderCount = ctx->orders.count;
+    header.productCount = ctx->products.count;
+    header.plantCount = ctx->plants.count;
+    header.numberOfDays = ctx->numberOfDays;
+    header.period = ctx->period;
+    memcpy(header.lastAlgorithm, ctx->lastAlgorithm, sizeof(header.lastAlgorithm));
+    if (extendable) memcpy(header.algorithm, schedule->algorithm, sizeof(header.algorithm));
+    header.plantStateCount = schedule->plantCount;
+    header.segmentCount = schedule->count;
+    header.scheduleOrderCount = schedule->orderCount;
+    header.rejectedCount = schedule->rejectedCount;
+    header.sequenceCount = extendable ? schedule->sequenceCount : 0;
+    header.idleDay = schedule->idleDay;
+    header.stepCount = extendable ? schedule->stepCount : 0;
+    header.seconds = schedule->seconds;
+    header.downtimeCount = ctx->downtimeCount;
+
+    const void* data[SECTION_COUNT] = {
+        ctx->orders.order_number, ctx->orders.due_day, ctx->orders.quantity, ctx->orders.product_id, ctx->orders.index,
+        ctx->products.name, ctx->products.index, ctx->plants.name, ctx->plants.capacity,
+        schedule->segments, schedule->plantOrder, schedule->rejected, schedule->dueKeys, schedule->sequence, schedule->steps,
+        ctx->downtime
+    };
+    uint64_t orderCount = (uint64_t)ctx->orders.count;
+    uint64_t keyCount = extendable ? (uint64_t)schedule->orderCount : 0;
+    uint64_t sizes[SECTION_COUNT] = {
+        orderCount * ORDER_ID, orderCount * sizeof(int), orderCount * sizeof(int), orderCount * sizeof(int),
+        ctx->orders.indexCapacity * sizeof(int),
+        (uint64_t)ctx->products.count * PRODUCT_NAME, ctx->products.indexCapacity * sizeof(int),
+        (uint64_t)ctx->plants.count * PLANT_NAME, (uint64_t)ctx->plants.count * sizeof(int),
+        (uint64_t)schedule->count * sizeof(Segment), 4 * (uint64_t)schedule->plantCount * sizeof(int),
+        (uint64_t)schedule->rejectedCount * sizeof(int), keyCount * sizeof(long long),
+        (uint64_t)header.sequenceCount * sizeof(int), (uint64_t)header.stepCount * sizeof(Step),
+        (uint64_t)header.downtimeCount * sizeof(Downtime)
+    };
+    uint64_t offset = sizeof(SnapshotHeader);
+    for (int i = 0; i < SECTION_COUNT; i++) {
+        header.sectionOffset[i] = offset;
+        header.sectionSize[i] = sizes[i];
+        offset += (sizes[i] + 7) & ~(uint64_t)7;
+    }
+    header.fileSize = offset;
+
+    uint64_t checksum = checksumWords(14695981039346656037ULL, &header, sizeof(header));
+    for (int i = 0; i < SECTION_COUNT; i++) {
+        checksum = checksumWords(checksum, data[i], (size_t)sizes[i]);
+    }
+    header.checksum = checksum;
+
+    char temporary[512];
+    if (snprintf(temporary, sizeof(temporary), "%s.tmp", file_name) >= (int)sizeof(temporary)) {
+        message(ctx, "Snapshot file name %s is too long.\n", file_name);
+        return false;
+    }
+    FILE* file = fopen(temporary, "wb");
+    if (file == NULL) {
+        message(ctx, "Error opening snapshot file %s.\n", file_name);
+        return false;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (int i = 0; i < SECTION_COUNT && ok; i++) {
+        ok = writeSection(file, data[i], sizes[i]);
+    }
+    ok = fclose(file) == 0 && ok;
+    if (!ok || rename(temporary, file_name) != 0) {
+        remove(temporary);
+        message(ctx, "Error writing snapshot file %s.\n", file_name);
+        return false;
+    }
+
+    message(ctx, "Snapshot saved to %s (%d orders, %d plants).\n", file_name, ctx->orders.count, ctx->plants.count);
+    return true;
+}
+
+// helper function to check that a section of a snapshot lies inside the file and has the size its counts call for
+static bool sectionFits(const SnapshotHeader* header, int section, uint64_t expected) {
+    uint64_t offset = header->sectionOffset[section], size = header->sectionSize[section];
+    return size == expected && offset % 8 == 0 && offset >= header->headerSize &&
+           offset <= header->fileSize && size <= header->fileSize - offset;
+}
+
+// helper function to check that a hash index capacity fits the rows it covers (a power of two, at most half full)
+static bool indexFits(uint64_t capacity, int count) {
+    if (count == 0) return capacity == 0 || (capacity & (capacity - 1)) == 0;
+    return (capacity & (capacity - 1)) == 0 && (uint64_t)count * 2 <= capacity;
+}
+
+// helper function to check the header of a mapped snapshot against its file
+static bool snapshotValid(const SnapshotHeader* header, const char* map, size_t size) {
+    if (header->orderCount < 0 || header->productCount < 0 || header->plantCount < 0 || header->plantStateCount < 0 ||
+        header->segmentCount < 0 || header->scheduleOrderCount < 0 || header->rejectedCount < 0 ||
+        header->sequenceCount < 0 || header->stepCount < 0 || header->downtimeCount < 0 || header->fileSize != size) {
+        return false;
+    }
+    if (!indexFits(header->orderIndexCapacity, header->orderCount) || !indexFits(header->productIndexCapacity, header->productCount)) {
+        return false;
+    }
+
+    uint64_t orderCount = (uint64_t)header->orderCount;
+    uint64_t keyCount = header->algorithm[0] != '\0' ? (uint64_t)header->scheduleOrderCount : 0;
+    uint64_t expected[SECTION_COUNT] = {
+        orderCount * ORDER_ID, orderCount * sizeof(int), orderCount * sizeof(int), orderCount * sizeof(int),
+        header->orderIndexCapacity * sizeof(int),
+        (uint64_t)header->productCount * PRODUCT_NAME, header->productIndexCapacity * sizeof(int),
+        (uint64_t)header->plantCount * PLANT_NAME, (uint64_t)header->plantCount * sizeof(int),
+        (uint64_t)header->segmentCount * sizeof(Segment), 4 * (uint64_t)header->plantStateCount * sizeof(int),
+        (uint64_t)header->rejectedCount * sizeof(int), keyCount * sizeof(long long),
+        (uint64_t)header->sequenceCount * sizeof(int), (uint64_t)header->stepCount * sizeof(Step),
+        (uint64_t)header->downtimeCount * sizeof(Downtime)
+    };
+    for (int i = 0; i < SECTION_COUNT; i++) {
+        if (!sectionFits(header, i, expected[i])) return false;
+    }
+
+    // every downtime has to belong to one of the plants of the snapshot, or to all of them
+    Downtime downtime;
+    for (int i = 0; i < header->downtimeCount; i++) {
+        memcpy(&downtime, map + header->sectionOffset[SECTION_DOWNTIME] + i * sizeof(Downtime), sizeof(Downtime));
+        if (downtime.plant < -1 || downtime.plant >= header->plantCount || downtime.last_day < downtime.first_day) return false;
+    }
+
+    // the names are used as C strings and the days are subtracted from each other, so every name has to end within
+    // its width and every day has to be one a date can give
+    int firstDay, lastDay;
+    parseDate("0000-01-01", 10, &firstDay);
+    parseDate("9999-12-31", 10, &lastDay);
+    const Period* period = &header->period;
+    if (memchr(period->start_date, '\0', DATE) == NULL || memchr(period->end_date, '\0', DATE) == NULL ||
+        period->start_day < firstDay || period->start_day > lastDay || period->end_day < firstDay || period->end_day > lastDay ||
+        header->numberOfDays != period->end_day - period->start_day) {
+        return false;
+    }
+    const char* orderNumbers = map + header->sectionOffset[SECTION_ORDER_NUMBER];
+    const int* dueDays = (const int*)(map + header->sectionOffset[SECTION_DUE_DAY]);
+    const int* productIds = (const int*)(map + header->sectionOffset[SECTION_PRODUCT_ID]);
+    for (int row = 0; row < header->orderCount; row++) {
+        if (memchr(orderNumbers + (size_t)row * ORDER_ID, '\0', ORDER_ID) == NULL) return false;
+        if (dueDays[row] < firstDay || dueDays[row] > lastDay) return false;
+        if (productIds[row] < 0 || productIds[row] >= header->productCount) return false;
+    }
+    const char* productNames = map + header->sectionOffset[SECTION_PRODUCT_NAME];
+    for (int row = 0; row < header->productCount; row++) {
+        if (memchr(productNames + (size_t)row * PRODUCT_NAME, '\0', PRODUCT_NAME) == NULL) return false;
+    }
+    const char* plantNames = map + header->sectionOffset[SECTION_PLANT_NAME];
+    for (int row = 0; row < header->plantCount; row++) {
+        if (memchr(plantNames + (size_t)row * PLANT_NAME, '\0', PLANT_NAME) == NULL) return false;
+    }
+
+    // the hash index slots hold row + 1, or 0 for an empty slot
+    const int* orderIndex = (const int*)(map + header->sectionOffset[SECTION_ORDER_INDEX]);
+    for (uint64_t i = 0; i < header->orderIndexCapacity; i++) {
+        if (orderIndex[i] < 0 || orderIndex[i] > header->orderCount) return false;
+    }
+    const int* productIndex = (const int*)(map + header->sectionOffset[SECTION_PRODUCT_INDEX]);
+    for (uint64_t i = 0; i < header->productIndexCapacity; i++) {
+        if (productIndex[i] < 0 || productIndex[i] > header->productCount) return false;
+    }
+
+    // the last schedule refers to its own plants and orders, which a schedule that can still be reported or extended
+    // shares with the snapshot (orders cleared after a run leave a schedule that is neither)
+    if (header->plantStateCount > header->plantCount) return false;
+    if ((header->algorithm[0] != '\0' || header->lastAlgorithm[0] != '\0') && header->scheduleOrderCount > header->orderCount) return false;
+    return scheduleRowsValid((const Segment*)(map + header->sectionOffset[SECTION_SEGMENTS]), header->segmentCount,
+                             (const int*)(map + header->sectionOffset[SECTION_PLANT_STATE]), header->plantStateCount,
+                             (const int*)(map + header->sectionOffset[SECTION_REJECTED]), header->rejectedCount,
+                             (const long long*)(map + header->sectionOffset[SECTION_DUE_KEYS]), (int)keyCount,
+                             (const int*)(map + header->sectionOffset[SECTION_SEQUENCE]), header->sequenceCount,
+                             header->scheduleOrderCount);
+}
+
+// helper function to copy an array out of a snapshot into memory of its own
+static bool copySection(void** array, const char* map, const SnapshotHeader* header, int section) {
+    *array = NULL;
+    if (header->sectionSize[section] == 0) return true;
+    *array = malloc((size_t)header->sectionSize[section]);
+    if (*array == NULL) return false;
+    memcpy(*array, map + header->sectionOffset[section], (size_t)header->sectionSize[section]);
+    return true;
+}
+
+// function to replace the orders, period, plants and last schedule with those of a snapshot file
+// the file is mapped and the order and product columns point straight into it; the first order added
+// after loading moves them into the arena, and the private mapping keeps any change out of the file
+static bool loadSnapshot(pls_context* ctx, const char* file_name) {
+    int fd = open(file_name, O_RDONLY);
+    if (fd < 0) {
+        message(ctx, "Error opening snapshot file %s.\n", file_name);
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) < 0 || (size_t)info.st_size < sizeof(SnapshotHeader)) {
+        close(fd);
+        message(ctx, "Snapshot file %s is not a valid PLS snapshot.\n", file_name);
+        return false;
+    }
+
+    size_t size = (size_t)info.st_size;
+    char* map = (char*)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        message(ctx, "Error mapping snapshot file %s.\n", file_name);
+        return false;
+    }
+
+    SnapshotHeader header;
+    memcpy(&header, map, sizeof(header));
+    if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+        munmap(map, size);
+        message(ctx, "Snapshot file %s is not a valid PLS snapshot.\n", file_name);
+        return false;
+    }
+    if (header.version != SNAPSHOT_VERSION || header.headerSize != sizeof(SnapshotHeader)) {
+        munmap(map, size);
+        message(ctx, "Snapshot file %s was written by an unsupported version (%u).\n", file_name, header.version);
+        return false;
+    }
+    uint64_t checksum = header.checksum;
+    header.checksum = 0;
+    if (checksumWords(checksumWords(14695981039346656037ULL, &header, sizeof(header)), map + sizeof(header), size - sizeof(header)) != checksum) {
+        munmap(map, size);
+        message(ctx, "Snapshot file %s is corrupt (checksum mismatch).\n", file_name);
+        return false;
+    }
+    if (!snapshotValid(&header, map, size)) {
+        munmap(map, size);
+        message(ctx, "Snapshot file %s is not a valid PLS snapshot.\n", file_name);
+        return false;
+    }
+
+    // the schedule and the calendar are copied first, so running out of memory leaves the context as it was
+    Schedule restored;
+    memset(&restored, 0, sizeof(restored));
+    Downtime* downtime = NULL;
+    bool ok = copySection((void**)&downtime, map, &header, SECTION_DOWNTIME);
+    if (header.plantStateCount > 0 && ok) {
+        ok = prepareSchedule(&restored, header.plantStateCount, header.scheduleOrderCount) &&
+             copySection((void**)&restored.segments, map, &header, SECTION_SEGMENTS) &&
+             copySection((void**)&restored.rejected, map, &header, SECTION_REJECTED) &&
+             copySection((void**)&restored.steps, map, &header, SECTION_STEPS);
+    }
+    if (!ok) {
+        freeSchedule(&restored);
+        free(downtime);
+        munmap(map, size);
+        message(ctx, "Out of memory. Snapshot %s not loaded.\n", file_name);
+        return false;
+    }
+    if (header.plantStateCount > 0) {
+        void* targets[3] = {restored.plantOrder, restored.dueKeys, restored.sequence};
+        const int sections[3] = {SECTION_PLANT_STATE, SECTION_DUE_KEYS, SECTION_SEQUENCE};
+        for (int i = 0; i < 3; i++) {
+            if (header.sectionSize[sections[i]] > 0) {
+                memcpy(targets[i], map + header.sectionOffset[sections[i]], (size_t)header.sectionSize[sections[i]]);
+            }
+        }
+        restored.count = restored.capacity = header.segmentCount;
+        restored.orderCount = header.scheduleOrderCount;
+        restored.rejectedCount = restored.rejectedCapacity = header.rejectedCount;
+        restored.seconds = header.seconds;
+        restored.sequenceCount = header.sequenceCount;
+        restored.idleDay = header.idleDay;
+        restored.stepCount = restored.stepCapacity = header.stepCount;
+    }
+
+    waitReports(ctx);
+    clearOrders(ctx);
+    clearPlants(ctx);
+    freeSchedule(&ctx->lastSchedule);
+
+    ctx->snapshotMap = map;
+    ctx->snapshotSize = size;
+    ctx->orders.count = ctx->orders.capacity = header.orderCount;
+    ctx->orders.order_number = (char (*)[ORDER_ID])(map + header.sectionOffset[SECTION_ORDER_NUMBER]);
+    ctx->orders.due_day = (int*)(map + header.sectionOffset[SECTION_DUE_DAY]);
+    ctx->orders.quantity = (int*)(map + header.sectionOffset[SECTION_QUANTITY]);
+    ctx->orders.product_id = (int*)(map + header.sectionOffset[SECTION_PRODUCT_ID]);
+    ctx->orders.index = (int*)(map + header.sectionOffset[SECTION_ORDER_INDEX]);
+    ctx->orders.indexCapacity = (size_t)header.orderIndexCapacity;
+    ctx->products.count = ctx->products.capacity = header.productCount;
+    ctx->products.name = (char (*)[PRODUCT_NAME])(map + header.sectionOffset[SECTION_PRODUCT_NAME]);
+    ctx->products.index = (int*)(map + header.sectionOffset[SECTION_PRODUCT_INDEX]);
+    ctx->products.indexCapacity = (size_t)header.productIndexCapacity;
+    for (int row = 0; row < ctx->orders.count; row++) {
+        ctx->orderHash = hashOrder(ctx, ctx->orderHash, row);
+    }
+
+    const char (*plantNames)[PLANT_NAME] = (const char (*)[PLANT_NAME])(map + header.sectionOffset[SECTION_PLANT_NAME]);
+    const int* capacities = (const int*)(map + header.sectionOffset[SECTION_PLANT_CAPACITY]);
+    for (int i = 0; i < header.plantCount && ok; i++) {
+        ok = appendPlant(ctx, plantNames[i], capacities[i]) >= 0;
+    }
+
+    free(ctx->downtime);
+    ctx->downtime = downtime;
+    ctx->downtimeCount = ctx->downtimeCapacity = header.downtimeCount;
+    ctx->period = header.period;
+    ctx->numberOfDays = header.numberOfDays;
+    ctx->setup++;
+    ctx->lastSchedule = restored;
+    memcpy(ctx->lastSchedule.algorithm, header.algorithm, sizeof(header.algorithm));
+    ctx->lastSchedule.setup = ctx->setup;
+    memcpy(ctx->lastAlgorithm, header.lastAlgorithm, sizeof(ctx->lastAlgorithm));
+    ctx->lastAlgorithm[sizeof(ctx->lastAlgorithm) - 1] = '\0';
+    ctx->lastSchedule.algorithm[sizeof(ctx->lastSchedule.algorithm) - 1] = '\0';
+
+    if (!ok) {
+        message(ctx, "Out of memory. Plants of snapshot %s not all loaded.\n", file_name);
+        return false;
+    }
+    message(ctx, "Snapshot loaded from %s (%d orders, %d plants).\n", file_name, ctx->orders.count, ctx->plants.count);
+    return true;
+}
+
+// function to create a context with the three default plants and no orders, NULL when out of memory
+pls_context* pls_create(void) {
+    pls_context* ctx = (pls_context*)calloc(1, sizeof(pls_context));
+    if (ctx == NULL) return NULL;
+
+    ctx->messages = stdout;
+    ctx->traceLevel = PLS_TRACE_DAYS;
+    ctx->reportFormat = PLS_REPORT_TEXT;
+    ctx->optBudget = 500;
+    ctx->orderHash = 14695981039346656037ULL;
+    ctx->cacheEnabled = true;
+    pthread_mutex_init(&ctx->reportLock, NULL);
+    pthread_cond_init(&ctx->reportChanged, NULL);
+    defaultPlants(ctx);
+    if (ctx->plants.count != 3) {
+        pls_destroy(ctx);
+        return NULL;
+    }
+    return ctx;
+}
+
+// function to release a context and everything it owns
+void pls_destroy(pls_context* ctx) {
+    if (ctx == NULL) return;
+
+    stopReportWriter(ctx);
+    clearOrders(ctx);
+    clearPlants(ctx);
+    clearCalendar(ctx);
+    clearCache(ctx);
+    freeSchedule(&ctx->lastSchedule);
+    free(ctx->outputBuffer);
+    free(ctx->convergence.points);
+    free(ctx->reportBuffer);
+    pthread_mutex_destroy(&ctx->reportLock);
+    pthread_cond_destroy(&ctx->reportChanged);
+    free(ctx);
+}
+
+// function to choose where a context prints its messages and traces (stdout by default, NULL for none)
+void pls_set_messages(pls_context* ctx, FILE* stream) {
+    ctx->messages = stream;
+}
+
+// function to choose how much a run prints: nothing, the rejected orders, or those and the day by day trace
+bool pls_set_trace_level(pls_context* ctx, int level) {
+    if (level < PLS_TRACE_NONE || level > PLS_TRACE_DAYS) {
+        message(ctx, "Invalid trace level %d (0 none, 1 rejections, 2 day by day).\n", level);
+        return false;
+    }
+    ctx->traceLevel = level;
+    message(ctx, "Trace level set to %d.\n", level);
+    return true;
+}
+
+// function to choose the format of the reports: text, CSV or TSV
+bool pls_set_report_format(pls_context* ctx, int format) {
+    if (format < PLS_REPORT_TEXT || format > PLS_REPORT_TSV) {
+        message(ctx, "Invalid report format %d.\n", format);
+        return false;
+    }
+    ctx->reportFormat = format;
+    message(ctx, "Report format set to %s.\n", format == PLS_REPORT_TEXT ? "TEXT" : format == PLS_REPORT_CSV ? "CSV" : "TSV");
+    return true;
+}
+
+// function to set the idle days a plant spends switching from one product to another in a GROUP run (0 by default)
+bool pls_set_changeover(pls_context* ctx, int days) {
+    if (days < 0 || days > MAX_CHANGEOVER) {
+        message(ctx, "Invalid changeover of %d days (0 to %d).\n", days, MAX_CHANGEOVER);
+        return false;
+    }
+    ctx->changeover = days;
+    message(ctx, "Changeover set to %d days.\n", days);
+    return true;
+}
+
+// function to set the milliseconds an OPT run searches for (500 by default)
+bool pls_set_opt_budget(pls_context* ctx, int milliseconds) {
+    if (milliseconds < 0 || milliseconds > MAX_OPT_BUDGET) {
+        message(ctx, "Invalid OPT budget of %d ms (0 to %d).\n", milliseconds, MAX_OPT_BUDGET);
+        return false;
+    }
+    ctx->optBudget = milliseconds;
+    message(ctx, "OPT budget set to %d ms.\n", milliseconds);
+    return true;
+}
+
+// function to set the scheduling period (YYYY-MM-DD dates)
+bool pls_set_period(pls_context* ctx, const char* start_date, const char* end_date) {
+    if (!period(ctx, start_date, end_date)) return false;
+    calculateDays(ctx);
+    return true;
+}
+
+// function to add a plant, or to change the capacity of a plant that already exists
+bool pls_add_plant(pls_context* ctx, const char* name, int capacity) {
+    return plant(ctx, name, capacity);
+}
+
+// function to take a plant out of service from one date to another, both included (maintenance, a breakdown)
+bool pls_add_downtime(pls_context* ctx, const char* plant_name, const char* first_date, const char* last_date) {
+    int row = findPlant(ctx, plant_name);
+    if (row < 0) {
+        message(ctx, "Plant %s not found.\n", plant_name);
+        return false;
+    }
+    return addDowntime(ctx, row, first_date, last_date);
+}
+
+// function to close every plant from one date to another, both included
+bool pls_add_holiday(pls_context* ctx, const char* first_date, const char* last_date) {
+    return addDowntime(ctx, -1, first_date, last_date);
+}
+
+// function to drop every downtime and holiday of a context
+void pls_clear_calendar(pls_context* ctx) {
+    clearCalendar(ctx);
+    message(ctx, "Plant calendar cleared.\n");
+}
+
+// function to add an order, false for a duplicate order number, an invalid due date or a quantity that is not positive
+bool pls_add_order(pls_context* ctx, const char* order_number, const char* due_date, int quantity, const char* product_name) {
+    if (strlen(order_number) >= ORDER_ID || strlen(product_name) >= PRODUCT_NAME) {
+        message(ctx, "Order number or product name too long. Order %.*s not added.\n", ORDER_ID - 1, order_number);
+        return false;
+    }
+    if (quantity <= 0) {
+        message(ctx, "Invalid quantity %d. Order %s not added.\n", quantity, order_number);
+        return false;
+    }
+    Stats* stats = activeStats(ctx);
+    struct timespec start;
+    statsStart(stats, &start);
+    bool ok = order(ctx, order_number, due_date, quantity, product_name);
+    statsStop(stats, PHASE_ORDER, &start);
+    return ok;
+}
+
+// function to add every addORDER line of a batch file
+bool pls_load_batch(pls_context* ctx, const char* file_name) {
+    Stats* stats = activeStats(ctx);
+    struct timespec start;
+    statsStart(stats, &start);
+    bool ok = loadBatch(ctx, file_name);
+    statsStop(stats, PHASE_BATCH, &start);
+    return ok;
+}
+
+// function to drop every order of a context
+void pls_clear_orders(pls_context* ctx) {
+    waitReports(ctx);
+    clearOrders(ctx);
+    ctx->lastAlgorithm[0] = '\0';
+}
+
+// function to get the number of orders in a context
+int pls_order_count(const pls_context* ctx) {
+    return ctx->orders.count;
+}
+
+// function to print the orders of a context
+void pls_print_orders(pls_context* ctx) {
+    printOrderHistory(ctx);
+}
+
+// function to schedule the orders with FCFS, SJF, EDF, GROUP or OPT, printing the rejections and the day by day trace
+bool pls_run(pls_context* ctx, const char* algorithm) {
+    if (strcasecmp(algorithm, "FCFS") != 0 && strcasecmp(algorithm, "SJF") != 0 && strcasecmp(algorithm, "EDF") != 0 &&
+        strcasecmp(algorithm, "GROUP") != 0 && strcasecmp(algorithm, "OPT") != 0) {
+        message(ctx, "Invalid algorithm: '%s'\n", algorithm);
+        return false;
+    }
+    reapReports(ctx);
+    return scheduleOrders(ctx, algorithm);
+}
+
+// function to write the report of the last schedule into a file
+bool pls_report(pls_context* ctx, const char* file_name) {
+    if (ctx->lastAlgorithm[0] == '\0') {
+        message(ctx, "Nothing has been scheduled yet.\n");
+        return false;
+    }
+    return printReport(ctx, ctx->lastAlgorithm, file_name, &ctx->lastSchedule);
+}
+
+// function to hand the report of the last schedule to a background writer and return at once
+bool pls_report_async(pls_context* ctx, const char* file_name) {
+    if (ctx->lastAlgorithm[0] == '\0') {
+        message(ctx, "Nothing has been scheduled yet.\n");
+        return false;
+    }
+    return queueReport(ctx, ctx->lastAlgorithm, file_name, &ctx->lastSchedule);
+}
+
+// function to wait for every report handed to the background writer, printing how each went, false if any failed
+bool pls_wait_reports(pls_context* ctx) {
+    return waitReports(ctx);
+}
+
+// function to print how the reports the background writer has finished went, returns how many are still being written
+int pls_pending_reports(pls_context* ctx) {
+    reapReports(ctx);
+    pthread_mutex_lock(&ctx->reportLock);
+    int pending = ctx->reportsPending;
+    pthread_mutex_unlock(&ctx->reportLock);
+    return pending;
+}
+
+// function to run every algorithm on the same orders in parallel and write a comparison report into a file
+bool pls_compare(pls_context* ctx, const char* file_name) {
+    return compareAlgorithms(ctx, file_name);
+}
+
+// function to schedule the orders under every combination of plant capacities and periods in a grid, in parallel,
+// and write a table of the outcome of each into a file
+bool pls_sweep(pls_context* ctx, const char* algorithm, const char* grid, const char* file_name) {
+    if (strcasecmp(algorithm, "FCFS") != 0 && strcasecmp(algorithm, "SJF") != 0 && strcasecmp(algorithm, "EDF") != 0 &&
+        strcasecmp(algorithm, "GROUP") != 0) {
+        message(ctx, "Invalid algorithm: '%s'\n", algorithm);
+        return false;
+    }
+    return sweepScenarios(ctx, algorithm, grid, file_name);
+}
+
+// function to get the figures of the last schedule, false if nothing has been scheduled yet
+bool pls_summarize(const pls_context* ctx, pls_summary* summary) {
+    if (ctx->lastAlgorithm[0] == '\0') return false;
+
+    const Schedule* schedule = &ctx->lastSchedule;
+    summary->accepted = schedule->orderCount - schedule->rejectedCount;
+    summary->rejected = schedule->rejectedCount;
+    summary->produced = 0;
+    for (int i = 0; i < schedule->plantCount; i++) summary->produced += schedule->produce[i];
+    summary->utilization = utilization(schedule, ctx->plants.capacity, -1);
+    summary->segments = schedule->count;
+    summary->changeovers = countChangeovers(schedule, ctx->orders.product_id, -1);
+    Snapshot snapshot;
+    memset(&snapshot, 0, sizeof(snapshot));
+    snapshot.due_day = ctx->orders.due_day;
+    snapshot.start_day = ctx->period.start_day;
+    summary->on_time = scoreSchedule(&snapshot, schedule).onTime;
+    summary->seconds = schedule->seconds;
+    return true;
+}
+
+// function to save the orders, period, plants and last schedule into a snapshot file
+bool pls_save_snapshot(pls_context* ctx, const char* file_name) {
+    Stats* stats = activeStats(ctx);
+    struct timespec start;
+    statsStart(stats, &start);
+    bool ok = saveSnapshot(ctx, file_name);
+    statsStop(stats, PHASE_SNAPSHOT, &start);
+    return ok;
+}
+
+// function to replace the orders, period, plants and last schedule with those of a snapshot file
+bool pls_load_snapshot(pls_context* ctx, const char* file_name) {
+    Stats* stats = activeStats(ctx);
+    struct timespec start;
+    statsStart(stats, &start);
+    bool ok = loadSnapshot(ctx, file_name);
+    statsStop(stats, PHASE_SNAPSHOT, &start);
+    return ok;
+}
+
+// function to turn the collection of statistics on or off (off by default, and free while off)
+void pls_enable_stats(pls_context* ctx, bool enabled) {
+    ctx->stats.enabled = enabled;
+    message(ctx, "Statistics %s.\n", enabled ? "on" : "off");
+}
+
+// function to zero the statistics of a context
+void pls_reset_stats(pls_context* ctx) {
+    bool enabled = ctx->stats.enabled;
+    memset(&ctx->stats, 0, sizeof(ctx->stats));
+    ctx->stats.enabled = enabled;
+}
+
+// function to print the statistics of a context
+void pls_print_stats(pls_context* ctx, FILE* stream) {
+    printStats(ctx, stream);
+}
+
+// function to turn the schedule cache on or off (on by default; turning it off drops the cached schedules)
+void pls_enable_cache(pls_context* ctx, bool enabled) {
+    if (!enabled) clearCache(ctx);
+    ctx->cacheEnabled = enabled;
+}
+
+// function to also keep the cached schedules as files in a directory, so later sessions can reuse them (NULL to stop)
+bool pls_set_cache_dir(pls_context* ctx, const char* directory) {
+    if (directory == NULL) {
+        ctx->cacheDir[0] = '\0';
+        message(ctx, "Schedule cache kept in memory only.\n");
+        return true;
+    }
+    struct stat info;
+    if (strlen(directory) >= sizeof(ctx->cacheDir) || stat(directory, &info) != 0 || !S_ISDIR(info.st_mode)) {
+        message(ctx, "Invalid cache directory %s.\n", directory);
+        return false;
+    }
+    strcpy(ctx->cacheDir, directory);
+    message(ctx, "Schedules will be cached in %s.\n", directory);
+    return true;
+}
+
+// function to append the statistics to a file after every run (NULL to stop)
+bool pls_set_stats_file(pls_context* ctx, const char* file_name) {
+    if (file_name == NULL) {
+        ctx->statsFile[0] = '\0';
+        return true;
+    }
+    if (strlen(file_name) >= sizeof(ctx->statsFile)) {
+        message(ctx, "Statistics file name too long.\n");
+        return false;
+    }
+    strcpy(ctx->statsFile, file_name);
+    message(ctx, "Statistics will be appended to %s after every run.\n", file_name);
+    return true;
+}
+
+// function to turn a day number (days since 1970-01-01) into a YYYY-MM-DD date
+void pls_format_date(int day, char* text) {
+    formatDate(day, text);
+}
+
+// function to get the next number of a seeded random sequence (xorshift64*)
+uint64_t pls_next_random(uint64_t* state) {
+    return nextRandom(state);
+}
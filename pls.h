@@ -0,0 +1,151 @@
+#ifndef PLS_H
+#define PLS_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// constant values (field sizes include the terminating '\0')
+#define ORDER_ID 10
+#define PRODUCT_NAME 10
+#define DATE 11
+#define PLANT_NAME 50
+
+// trace levels: how much a run prints to the message stream
+#define PLS_TRACE_NONE 0
+#define PLS_TRACE_REJECTIONS 1
+#define PLS_TRACE_DAYS 2
+
+// report formats
+#define PLS_REPORT_TEXT 0
+#define PLS_REPORT_CSV 1
+#define PLS_REPORT_TSV 2
+
+// a scheduling context: its own orders, plants, period and last schedule
+// (contexts share nothing, so separate contexts can be used from separate threads)
+typedef struct pls_context pls_context;
+
+// a structure for the figures of the last schedule of a context
+typedef struct pls_summary {
+    int accepted, rejected;
+    long long produced;
+    long long on_time;          // units produced by the due date of their order
+    double utilization;         // produced units over the capacity of the days the plants are in use
+    int segments;               // runs of days a plant spends on one order
+    int changeovers;            // times a plant switches from one product to another
+    double seconds;             // wall time of the scheduling run
+} pls_summary;
+
+// function to create a context with the three default plants and no orders, NULL when out of memory
+pls_context* pls_create(void);
+
+// function to release a context and everything it owns
+void pls_destroy(pls_context* ctx);
+
+// function to choose where a context prints its messages and traces (stdout by default, NULL for none)
+void pls_set_messages(pls_context* ctx, FILE* stream);
+
+// function to choose how much a run prints (PLS_TRACE_DAYS by default)
+bool pls_set_trace_level(pls_context* ctx, int level);
+
+// function to choose the format of the reports written by pls_report (PLS_REPORT_TEXT by default)
+bool pls_set_report_format(pls_context* ctx, int format);
+
+// function to set the idle days a plant spends switching from one product to another in a GROUP run (0 by default)
+bool pls_set_changeover(pls_context* ctx, int days);
+
+// function to set the milliseconds an OPT run searches for (500 by default)
+bool pls_set_opt_budget(pls_context* ctx, int milliseconds);
+
+// function to set the scheduling period (YYYY-MM-DD dates)
+bool pls_set_period(pls_context* ctx, const char* start_date, const char* end_date);
+
+// function to add a plant, or to change the capacity of a plant that already exists
+bool pls_add_plant(pls_context* ctx, const char* name, int capacity);
+
+// function to take a plant out of service from one date to another, both included (maintenance, a breakdown)
+bool pls_add_downtime(pls_context* ctx, const char* plant_name, const char* first_date, const char* last_date);
+
+// function to close every plant from one date to another, both included
+bool pls_add_holiday(pls_context* ctx, const char* first_date, const char* last_date);
+
+// function to drop every downtime and holiday of a context
+void pls_clear_calendar(pls_context* ctx);
+
+// function to add an order, false for a duplicate order number, an invalid due date or a quantity that is not positive
+bool pls_add_order(pls_context* ctx, const char* order_number, const char* due_date, int quantity, const char* product_name);
+
+// function to add every addORDER line of a batch file
+bool pls_load_batch(pls_context* ctx, const char* file_name);
+
+// function to drop every order of a context
+void pls_clear_orders(pls_context* ctx);
+
+// function to get the number of orders in a context
+int pls_order_count(const pls_context* ctx);
+
+// function to print the orders of a context
+void pls_print_orders(pls_context* ctx);
+
+// function to schedule the orders with FCFS, SJF, EDF, GROUP (whole products in a row on each plant) or OPT (a parallel
+// search for a sequence that gets more units done by their due dates, for the time budget), printing the rejections and the day by day trace as the trace level asks
+bool pls_run(pls_context* ctx, const char* algorithm);
+
+// function to write the report of the last schedule into a file
+bool pls_report(pls_context* ctx, const char* file_name);
+
+// function to hand the report of the last schedule to a background writer and return at once
+// (the writer works from a copy, so later commands can change the orders, plants and schedule meanwhile)
+bool pls_report_async(pls_context* ctx, const char* file_name);
+
+// function to wait for every report handed to the background writer, printing how each went, false if any failed
+bool pls_wait_reports(pls_context* ctx);
+
+// function to print how the reports the background writer has finished went, returns how many are still being written
+int pls_pending_reports(pls_context* ctx);
+
+// function to run every algorithm on the same orders in parallel and write a comparison report into a file
+bool pls_compare(pls_context* ctx, const char* file_name);
+
+// function to schedule the orders under every combination of a grid of plant capacities and periods, in parallel,
+// and write a table of utilization and rejections per scenario into a file
+// (the grid is space separated NAME=value,value,... axes: an existing plant, a new plant, or PERIOD with
+//  YYYY-MM-DD:YYYY-MM-DD values; a capacity of 0 leaves the plant out)
+bool pls_sweep(pls_context* ctx, const char* algorithm, const char* grid, const char* file_name);
+
+// function to get the figures of the last schedule, false if nothing has been scheduled yet
+bool pls_summarize(const pls_context* ctx, pls_summary* summary);
+
+// function to save the orders, period, plants and last schedule into a binary snapshot file
+bool pls_save_snapshot(pls_context* ctx, const char* file_name);
+
+// function to replace the orders, period, plants and last schedule with those of a snapshot file
+// (the file is mapped rather than parsed, and must come from a build with the same snapshot version)
+bool pls_load_snapshot(pls_context* ctx, const char* file_name);
+
+// function to turn the collection of phase timers, counters and histograms on or off (off by default)
+void pls_enable_stats(pls_context* ctx, bool enabled);
+
+// function to zero the statistics of a context
+void pls_reset_stats(pls_context* ctx);
+
+// function to print the statistics of a context
+void pls_print_stats(pls_context* ctx, FILE* stream);
+
+// function to turn the schedule cache on or off (on by default; turning it off drops the cached schedules)
+// (a run on the same orders, period, plants, calendar and algorithm settings as a cached run reuses its schedule)
+void pls_enable_cache(pls_context* ctx, bool enabled);
+
+// function to also keep the cached schedules as files in a directory, so later sessions can reuse them (NULL to stop)
+bool pls_set_cache_dir(pls_context* ctx, const char* directory);
+
+// function to append the statistics to a file after every run (NULL to stop)
+bool pls_set_stats_file(pls_context* ctx, const char* file_name);
+
+// function to turn a day number (days since 1970-01-01) into a YYYY-MM-DD date, text holds at least DATE chars
+void pls_format_date(int day, char* text);
+
+// function to get the next number of a seeded random sequence (xorshift64*), the state must not be zero
+uint64_t pls_next_random(uint64_t* state);
+
+#endif
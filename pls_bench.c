@@ -0,0 +1,366 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "pls.h"
+
+// constant values
+#define MAX_SIZES 16
+#define START_DAY 19875         // 2024-06-01, the first day of the generated scheduling period
+
+// a structure for the benchmark settings
+typedef struct Settings {
+    unsigned long long seed;
+    int sizes[MAX_SIZES], sizeCount;
+    const char* due;            // uniform, early or late
+    double skew;                // quantity = 1 + maxQuantity * u^skew, so a larger skew means more small orders
+    int maxQuantity;
+    int plants, days;
+    double load;                // total demand over total capacity of the period
+    int repeats;
+    const char* output;
+} Settings;
+
+// a structure for a generated order book
+typedef struct Book {
+    int count;
+    int* due_day;
+    int* quantity;
+    int* product;
+} Book;
+
+// helper function to get a uniform number in [0, 1) from the generator
+static double nextUniform(uint64_t* state) {
+    return (double)(pls_next_random(state) >> 11) / 9007199254740992.0;
+}
+
+// helper function to get the seconds passed since a monotonic clock reading
+static double secondsSince(const struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// helper function to compare two doubles for qsort
+static int compareDoubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// helper function to get a percentile of sorted samples (nearest rank)
+static double percentile(const double* sorted, int count, double p) {
+    if (count == 0) return 0;
+    int rank = (int)(p / 100.0 * count + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > count) rank = count;
+    return sorted[rank - 1];
+}
+
+// helper function to print the percentiles of a set of samples as a JSON object (sorts the samples)
+static void printPercentiles(FILE* out, const char* name, double* samples, int count, double scale) {
+    qsort(samples, (size_t)count, sizeof(double), compareDoubles);
+    fprintf(out, "\"%s\": {\"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f}", name,
+        percentile(samples, count, 50) * scale, percentile(samples, count, 90) * scale,
+        percentile(samples, count, 99) * scale, count > 0 ? samples[count - 1] * scale : 0);
+}
+
+// function to generate a reproducible order book of the given size
+static bool generateBook(const Settings* settings, int count, Book* book) {
+    book->count = count;
+    book->due_day = (int*)malloc(sizeof(int) * (size_t)count);
+    book->quantity = (int*)malloc(sizeof(int) * (size_t)count);
+    book->product = (int*)malloc(sizeof(int) * (size_t)count);
+    if (book->due_day == NULL || book->quantity == NULL || book->product == NULL) return false;
+
+    uint64_t state = settings->seed * 0x9E3779B97F4A7C15ULL + (uint64_t)count;
+    if (state == 0) state = 1;
+    for (int i = 0; i < count; i++) {
+        double u = nextUniform(&state);
+        if (strcmp(settings->due, "early") == 0) {
+            u = u * u;
+        } else if (strcmp(settings->due, "late") == 0) {
+            u = 1 - (1 - u) * (1 - u);
+        }
+        book->due_day[i] = START_DAY + 1 + (int)(u * settings->days);
+        book->quantity[i] = 1 + (int)(settings->maxQuantity * pow(nextUniform(&state), settings->skew));
+        book->product[i] = (int)(pls_next_random(&state) % 64);
+    }
+    return true;
+}
+
+// function to release a generated order book
+static void freeBook(Book* book) {
+    free(book->due_day);
+    free(book->quantity);
+    free(book->product);
+    memset(book, 0, sizeof(Book));
+}
+
+// helper function to set the period and size the plants so the book asks for the given share of their capacity
+static void setUpPlants(const Settings* settings, const Book* book, pls_context* ctx) {
+    char start[DATE], end[DATE];
+    pls_format_date(START_DAY, start);
+    pls_format_date(START_DAY + settings->days, end);
+    pls_set_period(ctx, start, end);
+
+    long long demand = 0;
+    for (int i = 0; i < book->count; i++) demand += book->quantity[i];
+    double perPlant = (double)demand / (settings->load * settings->days * settings->plants);
+    int capacity = perPlant < 1 ? 1 : perPlant > 2e9 ? 2000000000 : (int)ceil(perPlant);
+
+    const char* defaults[3] = {"Plant_X", "Plant_Y", "Plant_Z"};
+    for (int i = 0; i < settings->plants; i++) {
+        char name[PLANT_NAME];
+        if (i < 3) {
+            snprintf(name, sizeof(name), "%s", defaults[i]);
+        } else {
+            snprintf(name, sizeof(name), "Bench_%d", i);
+        }
+        pls_add_plant(ctx, name, capacity);
+    }
+}
+
+// function to time adding the book one order at a time (the order() path)
+static bool benchOrders(const Book* book, pls_context* ctx, FILE* out) {
+    double* samples = (double*)malloc(sizeof(double) * ((size_t)book->count + 1));
+    if (samples == NULL) return false;
+
+    double total = 0;
+    for (int i = 0; i < book->count; i++) {
+        char order_number[16], due_date[DATE], product_name[PRODUCT_NAME];
+        snprintf(order_number, sizeof(order_number), "O%d", i);
+        pls_format_date(book->due_day[i], due_date);
+        snprintf(product_name, sizeof(product_name), "P%d", book->product[i]);
+
+        struct timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        pls_add_order(ctx, order_number, due_date, book->quantity[i], product_name);
+        samples[i] = secondsSince(&start);
+        total += samples[i];
+    }
+
+    fprintf(out, "      \"ingest_order\": {\"seconds\": %.6f, \"orders_per_second\": %.0f, ", total, total > 0 ? book->count / total : 0);
+    printPercentiles(out, "latency_ns", samples, book->count, 1e9);
+    fprintf(out, "},\n");
+    free(samples);
+    return true;
+}
+
+// function to time loading the book from a batch file (the addBATCH path), leaving it loaded
+static bool benchBatch(const Settings* settings, const Book* book, pls_context* ctx, FILE* out) {
+    const char* directory = getenv("TMPDIR");
+    char path[512];
+    snprintf(path, sizeof(path), "%s/pls_bench_XXXXXX", directory != NULL ? directory : "/tmp");
+    int fd = mkstemp(path);
+    FILE* file = fd >= 0 ? fdopen(fd, "w") : NULL;
+    if (file == NULL) {
+        if (fd >= 0) close(fd);
+        fprintf(stderr, "Error creating batch file %s.\n", path);
+        return false;
+    }
+    for (int i = 0; i < book->count; i++) {
+        char due_date[DATE];
+        pls_format_date(book->due_day[i], due_date);
+        fprintf(file, "addORDER O%d %s %d P%d\n", i, due_date, book->quantity[i], book->product[i]);
+    }
+    fclose(file);
+
+    double* samples = (double*)malloc(sizeof(double) * (size_t)settings->repeats);
+    if (samples == NULL) {
+        unlink(path);
+        return false;
+    }
+    for (int r = 0; r < settings->repeats; r++) {
+        pls_clear_orders(ctx);
+        struct timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        pls_load_batch(ctx, path);
+        samples[r] = secondsSince(&start);
+    }
+    unlink(path);
+
+    qsort(samples, (size_t)settings->repeats, sizeof(double), compareDoubles);
+    double median = percentile(samples, settings->repeats, 50);
+    fprintf(out, "      \"ingest_batch\": {\"orders_per_second\": %.0f, ", median > 0 ? book->count / median : 0);
+    printPercentiles(out, "latency_ms", samples, settings->repeats, 1e3);
+    fprintf(out, "},\n");
+    free(samples);
+    return true;
+}
+
+// function to time full scheduling runs of each algorithm on the loaded book
+static bool benchSchedules(const Settings* settings, const Book* book, pls_context* ctx, FILE* out) {
+    const char* algorithms[4] = {"FCFS", "SJF", "EDF", "GROUP"};
+    double* samples = (double*)malloc(sizeof(double) * (size_t)settings->repeats);
+    if (samples == NULL) return false;
+
+    char start[DATE], end[DATE];
+    pls_format_date(START_DAY, start);
+    pls_format_date(START_DAY + settings->days, end);
+
+    fprintf(out, "      \"schedule\": {\n");
+    for (int a = 0; a < 4; a++) {
+        pls_summary summary;
+        memset(&summary, 0, sizeof(summary));
+        for (int r = 0; r < settings->repeats; r++) {
+            // setting the period again makes every run a full rebuild rather than an extension of the last one
+            pls_set_period(ctx, start, end);
+            struct timespec begin;
+            clock_gettime(CLOCK_MONOTONIC, &begin);
+            pls_run(ctx, algorithms[a]);
+            samples[r] = secondsSince(&begin);
+        }
+        pls_summarize(ctx, &summary);
+
+        qsort(samples, (size_t)settings->repeats, sizeof(double), compareDoubles);
+        double median = percentile(samples, settings->repeats, 50);
+        fprintf(out, "        \"%s\": {\"accepted\": %d, \"rejected\": %d, \"segments\": %d, \"changeovers\": %d, \"on_time\": %lld, \"utilization\": %.4f, \"orders_per_second\": %.0f, ",
+            algorithms[a], summary.accepted, summary.rejected, summary.segments, summary.changeovers, summary.on_time, summary.utilization, median > 0 ? book->count / median : 0);
+        printPercentiles(out, "latency_ms", samples, settings->repeats, 1e3);
+        fprintf(out, "}%s\n", a < 3 ? "," : "");
+    }
+    fprintf(out, "      },\n");
+    free(samples);
+    return true;
+}
+
+// helper function to generate an order book of one size and run every benchmark on it, printing all but the
+// memory figure of its JSON object (run in a child process, whose exit flushes the output)
+static bool benchSize(const Settings* settings, int size, FILE* out) {
+    Book book;
+    memset(&book, 0, sizeof(book));
+    pls_context* ctx = pls_create();
+    bool ok = ctx != NULL && generateBook(settings, size, &book);
+    if (ok) {
+        pls_set_messages(ctx, NULL);
+        pls_set_trace_level(ctx, PLS_TRACE_NONE);
+        // every repeat has to schedule for real, not reuse the first run's schedule
+        pls_enable_cache(ctx, false);
+        setUpPlants(settings, &book, ctx);
+
+        fprintf(out, "    {\n      \"orders\": %d,\n", book.count);
+        ok = benchOrders(&book, ctx, out) && benchBatch(settings, &book, ctx, out) && benchSchedules(settings, &book, ctx, out);
+        fflush(out);
+    }
+    pls_destroy(ctx);
+    freeBook(&book);
+    return ok;
+}
+
+// helper function to read a comma separated list of sizes
+static bool parseSizes(const char* text, Settings* settings) {
+    settings->sizeCount = 0;
+    while (*text) {
+        char* end;
+        long size = strtol(text, &end, 10);
+        if (end == text || size <= 0 || size > 99999999 || settings->sizeCount == MAX_SIZES) return false;
+        settings->sizes[settings->sizeCount++] = (int)size;
+        text = *end == ',' ? end + 1 : end;
+        if (*end != ',' && *end != '\0') return false;
+    }
+    return settings->sizeCount > 0;
+}
+
+// helper function to print how the benchmark is used
+static void usage(const char* program) {
+    fprintf(stderr,
+        "usage: %s [--seed N] [--sizes 1000,10000,...] [--due uniform|early|late] [--skew S]\n"
+        "          [--max-quantity Q] [--plants P] [--days D] [--load L] [--repeats R] [--output FILE]\n", program);
+}
+
+// main function
+int main(int argc, char* argv[]) {
+    Settings settings = {1, {1000, 10000, 100000, 1000000, 10000000}, 5, "uniform", 2.0, 5000, 16, 365, 0.9, 5, NULL};
+
+    for (int i = 1; i < argc; i++) {
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        bool ok = value != NULL;
+        if (ok && strcmp(argv[i], "--seed") == 0) {
+            settings.seed = strtoull(value, NULL, 10);
+        } else if (ok && strcmp(argv[i], "--sizes") == 0) {
+            ok = parseSizes(value, &settings);
+        } else if (ok && strcmp(argv[i], "--due") == 0) {
+            settings.due = value;
+            ok = strcmp(value, "uniform") == 0 || strcmp(value, "early") == 0 || strcmp(value, "late") == 0;
+        } else if (ok && strcmp(argv[i], "--skew") == 0) {
+            settings.skew = atof(value);
+            ok = settings.skew > 0;
+        } else if (ok && strcmp(argv[i], "--max-quantity") == 0) {
+            settings.maxQuantity = atoi(value);
+            ok = settings.maxQuantity > 0;
+        } else if (ok && strcmp(argv[i], "--plants") == 0) {
+            settings.plants = atoi(value);
+            ok = settings.plants >= 3;
+        } else if (ok && strcmp(argv[i], "--days") == 0) {
+            settings.days = atoi(value);
+            ok = settings.days > 0;
+        } else if (ok && strcmp(argv[i], "--load") == 0) {
+            settings.load = atof(value);
+            ok = settings.load > 0;
+        } else if (ok && strcmp(argv[i], "--repeats") == 0) {
+            settings.repeats = atoi(value);
+            ok = settings.repeats > 0;
+        } else if (ok && strcmp(argv[i], "--output") == 0) {
+            settings.output = value;
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+
+    FILE* out = settings.output != NULL ? fopen(settings.output, "w") : stdout;
+    if (out == NULL) {
+        fprintf(stderr, "Error opening output file %s.\n", settings.output);
+        return 1;
+    }
+
+    fprintf(out, "{\n  \"benchmark\": \"pls\",\n  \"seed\": %llu,\n  \"due_distribution\": \"%s\",\n  \"quantity_skew\": %.3f,\n"
+        "  \"max_quantity\": %d,\n  \"plants\": %d,\n  \"days\": %d,\n  \"load\": %.3f,\n  \"repeats\": %d,\n  \"results\": [\n",
+        settings.seed, settings.due, settings.skew, settings.maxQuantity, settings.plants, settings.days, settings.load, settings.repeats);
+
+    // each size runs in a child process of its own, so the peak resident set size is that of the size alone;
+    // the child writes its object to a scratch file that is only copied out when it succeeds, and a size that
+    // fails gets an error entry instead, so the JSON stays whole
+    bool ok = true;
+    for (int s = 0; s < settings.sizeCount && ok; s++) {
+        fflush(out);
+        FILE* result = tmpfile();
+        pid_t child = result != NULL ? fork() : -1;
+        if (child == 0) {
+            exit(benchSize(&settings, settings.sizes[s], result) ? 0 : 1);
+        }
+        int status;
+        struct rusage usage;
+        ok = child > 0 && wait4(child, &status, 0, &usage) == child && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        if (ok) {
+            char chunk[4096];
+            size_t length;
+            rewind(result);
+            while ((length = fread(chunk, 1, sizeof(chunk), result)) > 0) fwrite(chunk, 1, length, out);
+            fprintf(out, "      \"peak_rss_kb\": %ld\n    }%s\n", usage.ru_maxrss, s + 1 < settings.sizeCount ? "," : "");
+        } else {
+            fprintf(out, "    {\n      \"orders\": %d,\n      \"error\": \"out of memory or batch file error\"\n    }\n", settings.sizes[s]);
+        }
+        fflush(out);
+        if (result != NULL) fclose(result);
+    }
+    fprintf(out, "  ]\n}\n");
+
+    if (out != stdout) fclose(out);
+    if (!ok) {
+        fprintf(stderr, "Benchmark stopped: out of memory or batch file error.\n");
+        return 1;
+    }
+    return 0;
+}
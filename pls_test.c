@@ -0,0 +1,263 @@
+// checks of the scheduling engine against simpler reference versions and full runs on seeded small order books
+// the engine's helpers are static, so the library source is compiled into the test program:
+//   gcc -pthread -o pls_test pls_test.c && ./pls_test [seeds]
+#include "pls.c"
+
+// constant values of the generated order books
+#define TEST_MAX_ORDERS 40
+#define TEST_MAX_PLANTS 5
+#define TEST_MAX_DAYS 40
+#define TEST_MAX_DOWNTIME 4
+
+// a structure for a generated order book with its plants, period and calendar
+typedef struct TestBook {
+    int orderCount, plantCount, numDays, downtimeCount;
+    int due_day[TEST_MAX_ORDERS], quantity[TEST_MAX_ORDERS], product_id[TEST_MAX_ORDERS];
+    int capacity[TEST_MAX_PLANTS];
+    Downtime downtime[TEST_MAX_DOWNTIME];
+} TestBook;
+
+// helper function to get a number from 0 to limit - 1
+static int nextBelow(uint64_t* state, int limit) {
+    return (int)(nextRandom(state) % (uint64_t)limit);
+}
+
+// helper function to generate a small order book; quantities and capacities come from short lists so that ties are common
+static void generateTestBook(uint64_t seed, TestBook* book) {
+    static const int quantities[] = {100, 250, 300, 400, 500, 600, 800, 1200, 1500, 2000, 3000};
+    static const int capacities[] = {100, 200, 300, 300, 400, 500};
+    uint64_t state = seed * 2654435761ULL + 1;
+
+    memset(book, 0, sizeof(TestBook));
+    book->orderCount = 1 + nextBelow(&state, TEST_MAX_ORDERS);
+    book->plantCount = 1 + nextBelow(&state, TEST_MAX_PLANTS);
+    book->numDays = 1 + nextBelow(&state, TEST_MAX_DAYS);
+    for (int k = 0; k < book->plantCount; k++) {
+        book->capacity[k] = capacities[nextBelow(&state, (int)(sizeof(capacities) / sizeof(int)))];
+    }
+    for (int i = 0; i < book->orderCount; i++) {
+        book->due_day[i] = nextBelow(&state, book->numDays + 10);
+        book->quantity[i] = quantities[nextBelow(&state, (int)(sizeof(quantities) / sizeof(int)))];
+        book->product_id[i] = nextBelow(&state, 4);
+    }
+    book->downtimeCount = nextBelow(&state, TEST_MAX_DOWNTIME + 1);
+    for (int i = 0; i < book->downtimeCount; i++) {
+        Downtime* downtime = &book->downtime[i];
+        downtime->plant = nextBelow(&state, book->plantCount + 1) - 1;
+        downtime->first_day = nextBelow(&state, book->numDays);
+        downtime->last_day = downtime->first_day + nextBelow(&state, 4);
+    }
+}
+
+// helper function to take the view a scheduling run works from of a generated order book
+static Snapshot testSnapshot(const TestBook* book) {
+    Snapshot snapshot;
+    memset(&snapshot, 0, sizeof(snapshot));
+    snapshot.orderCount = book->orderCount;
+    snapshot.due_day = book->due_day;
+    snapshot.quantity = book->quantity;
+    snapshot.product_id = book->product_id;
+    snapshot.productCount = 4;
+    snapshot.plantCount = book->plantCount;
+    snapshot.capacity = book->capacity;
+    snapshot.downtime = book->downtime;
+    snapshot.downtimeCount = book->downtimeCount;
+    snapshot.numDays = book->numDays;
+    snapshot.optBudget = 1;
+    return snapshot;
+}
+
+// helper function to check whether a plant of a generated order book is down on a day
+static bool testPlantDown(const TestBook* book, int plant, int day) {
+    for (int i = 0; i < book->downtimeCount; i++) {
+        const Downtime* downtime = &book->downtime[i];
+        if ((downtime->plant < 0 || downtime->plant == plant) && downtime->first_day <= day && day <= downtime->last_day) return true;
+    }
+    return false;
+}
+
+// function to check the heap SJF engine against the original rescan: each day, over and over, the free plant and the
+// order not yet picked that day with the smallest quantity/capacity ratio are paired (ties go to the lower plant, then
+// to the earlier order), until no plant or no order is left; both have to give every plant the same order and units every day
+static bool testShortestJobFirst(uint64_t seed) {
+    TestBook book;
+    generateTestBook(seed, &book);
+    Snapshot snapshot = testSnapshot(&book);
+    Schedule schedule;
+    memset(&schedule, 0, sizeof(schedule));
+    if (!assignOrdersToPlantsSJF(&snapshot, &schedule, false)) {
+        printf("SJF seed %llu: out of memory\n", (unsigned long long)seed);
+        return false;
+    }
+
+    // the engine's allocations expanded day by day, as (row, units) per plant
+    int engine[TEST_MAX_DAYS][TEST_MAX_PLANTS][2], reference[TEST_MAX_DAYS][TEST_MAX_PLANTS][2];
+    memset(engine, -1, sizeof(engine));
+    memset(reference, -1, sizeof(reference));
+    for (int s = 0; s < schedule.count; s++) {
+        const Segment* segment = &schedule.segments[s];
+        for (int day = segment->start_day; day < segment->start_day + segment->run_length; day++) {
+            engine[day][segment->plant][0] = segment->order;
+            engine[day][segment->plant][1] = segment->units;
+        }
+    }
+
+    // the reference works on the orders the admission check accepted, in arrival order
+    bool rejected[TEST_MAX_ORDERS] = {false};
+    for (int i = 0; i < schedule.rejectedCount; i++) rejected[schedule.rejected[i]] = true;
+    int remaining[TEST_MAX_ORDERS];
+    for (int row = 0; row < book.orderCount; row++) remaining[row] = rejected[row] ? 0 : book.quantity[row];
+
+    for (int day = 0; day < book.numDays; day++) {
+        bool plantTaken[TEST_MAX_PLANTS] = {false}, orderTaken[TEST_MAX_ORDERS] = {false};
+        for (int k = 0; k < book.plantCount; k++) plantTaken[k] = testPlantDown(&book, k, day);
+        while (1) {
+            double minTime = 1e9;
+            int minPlant = -1, minOrder = -1;
+            for (int k = 0; k < book.plantCount; k++) {
+                if (plantTaken[k]) continue;
+                for (int row = 0; row < book.orderCount; row++) {
+                    if (orderTaken[row] || remaining[row] <= 0) continue;
+                    double processingTime = (double)remaining[row] / book.capacity[k];
+                    if (processingTime < minTime) {
+                        minTime = processingTime;
+                        minPlant = k;
+                        minOrder = row;
+                    }
+                }
+            }
+            if (minPlant < 0) break;
+
+            int production = remaining[minOrder] < book.capacity[minPlant] ? remaining[minOrder] : book.capacity[minPlant];
+            reference[day][minPlant][0] = minOrder;
+            reference[day][minPlant][1] = production;
+            remaining[minOrder] -= production;
+            plantTaken[minPlant] = true;
+            orderTaken[minOrder] = true;
+        }
+    }
+
+    bool same = true;
+    for (int day = 0; day < book.numDays && same; day++) {
+        for (int k = 0; k < book.plantCount && same; k++) {
+            if (engine[day][k][0] != reference[day][k][0] || engine[day][k][1] != reference[day][k][1]) {
+                printf("SJF seed %llu: day %d plant %d has order %d x %d, the rescan gives order %d x %d\n", (unsigned long long)seed,
+                    day + 1, k, engine[day][k][0], engine[day][k][1], reference[day][k][0], reference[day][k][1]);
+                same = false;
+            }
+        }
+    }
+    freeSchedule(&schedule);
+    return same;
+}
+
+// helper function to add orders from one row of a generated order book up to another to a context
+static bool testAddOrders(pls_context* ctx, const TestBook* book, int from, int to) {
+    int start_day = ctx->period.start_day;
+    for (int i = from; i < to; i++) {
+        char order_number[ORDER_ID], due_date[DATE], product_name[PRODUCT_NAME];
+        snprintf(order_number, sizeof(order_number), "T%03d", i % 1000);
+        snprintf(product_name, sizeof(product_name), "Product_%c", 'A' + book->product_id[i]);
+        formatDate(start_day + book->due_day[i], due_date);
+        if (!pls_add_order(ctx, order_number, due_date, book->quantity[i], product_name)) return false;
+    }
+    return true;
+}
+
+// helper function to set up a context with the plants, period and calendar of a generated order book
+// (plants beyond the three the factory starts with are added, and the cache is off so every run really schedules)
+static pls_context* testContext(const TestBook* book) {
+    static const char* plantNames[TEST_MAX_PLANTS] = {"Plant_X", "Plant_Y", "Plant_Z", "Plant_V", "Plant_W"};
+    pls_context* ctx = pls_create();
+    if (ctx == NULL) return NULL;
+    pls_set_messages(ctx, NULL);
+    pls_enable_cache(ctx, false);
+    pls_enable_stats(ctx, true);
+
+    int start_day;
+    char start_date[DATE], end_date[DATE], first_date[DATE], last_date[DATE];
+    parseDate("2024-06-01", 10, &start_day);
+    formatDate(start_day, start_date);
+    formatDate(start_day + book->numDays - 1, end_date);
+    bool ok = pls_set_period(ctx, start_date, end_date);
+    for (int k = 0; k < book->plantCount && ok; k++) ok = pls_add_plant(ctx, plantNames[k], book->capacity[k]);
+    for (int i = 0; i < book->downtimeCount && ok; i++) {
+        const Downtime* downtime = &book->downtime[i];
+        formatDate(start_day + downtime->first_day, first_date);
+        formatDate(start_day + downtime->last_day, last_date);
+        ok = downtime->plant < 0 ? pls_add_holiday(ctx, first_date, last_date)
+                                 : pls_add_downtime(ctx, plantNames[downtime->plant], first_date, last_date);
+    }
+    if (!ok) {
+        pls_destroy(ctx);
+        return NULL;
+    }
+    return ctx;
+}
+
+// function to check an extended schedule against a full run: one context runs the algorithm on part of the orders,
+// then gets the rest in two lots and runs after each (so the runs after the first extend the last schedule), while a
+// fresh context gets every order and runs once; both have to end with the same segments and the same rejected orders
+static bool testExtension(const char* algorithm, uint64_t seed, long long* extended) {
+    TestBook book;
+    generateTestBook(seed, &book);
+    uint64_t state = seed * 0x9e3779b97f4a7c15ULL + 7;
+    int first = 1 + nextBelow(&state, book.orderCount);
+    int second = first + nextBelow(&state, book.orderCount - first + 1);
+
+    pls_context* extending = testContext(&book);
+    pls_context* fresh = testContext(&book);
+    bool ok = extending != NULL && fresh != NULL;
+    ok = ok && testAddOrders(extending, &book, 0, first) && pls_run(extending, algorithm);
+    ok = ok && testAddOrders(extending, &book, first, second) && pls_run(extending, algorithm);
+    ok = ok && testAddOrders(extending, &book, second, book.orderCount) && pls_run(extending, algorithm);
+    ok = ok && testAddOrders(fresh, &book, 0, book.orderCount) && pls_run(fresh, algorithm);
+    if (!ok) {
+        printf("%s seed %llu: a run failed\n", algorithm, (unsigned long long)seed);
+        pls_destroy(extending);
+        pls_destroy(fresh);
+        return false;
+    }
+
+    const Schedule* a = &extending->lastSchedule;
+    const Schedule* b = &fresh->lastSchedule;
+    bool same = a->count == b->count && a->rejectedCount == b->rejectedCount &&
+                (a->count == 0 || memcmp(a->segments, b->segments, sizeof(Segment) * (size_t)a->count) == 0) &&
+                (a->rejectedCount == 0 || memcmp(a->rejected, b->rejected, sizeof(int) * (size_t)a->rejectedCount) == 0);
+    if (!same) {
+        printf("%s seed %llu: extended after %d and %d of %d orders gives %d segments and %d rejected, a full run %d and %d\n",
+            algorithm, (unsigned long long)seed, first, second, book.orderCount, a->count, a->rejectedCount, b->count, b->rejectedCount);
+    }
+    *extended += extending->stats.runsExtended;
+    pls_destroy(extending);
+    pls_destroy(fresh);
+    return same;
+}
+
+int main(int argc, char* argv[]) {
+    int seeds = argc > 1 ? atoi(argv[1]) : 500;
+    int failed = 0;
+
+    for (int seed = 1; seed <= seeds; seed++) {
+        if (!testShortestJobFirst((uint64_t)seed)) failed++;
+    }
+    printf("SJF heap against rescan: %d of %d seeds differ\n", failed, seeds);
+
+    // GROUP always rebuilds its schedule, so only the algorithms that extend one are checked; over 50 seeds or more
+    // some runs always take the extension path, so a check where none did fails too
+    static const char* algorithms[] = {"FCFS", "SJF", "EDF"};
+    for (int i = 0; i < (int)(sizeof(algorithms) / sizeof(algorithms[0])); i++) {
+        int differ = 0;
+        long long extended = 0;
+        for (int seed = 1; seed <= seeds; seed++) {
+            if (!testExtension(algorithms[i], (uint64_t)seed, &extended)) differ++;
+        }
+        printf("%s extended against full run: %d of %d seeds differ (%lld runs extended)\n", algorithms[i], differ, seeds, extended);
+        failed += differ;
+        if (extended == 0 && seeds >= 50) {
+            printf("%s extended against full run: no run extended the last schedule\n", algorithms[i]);
+            failed++;
+        }
+    }
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}